@@ -0,0 +1,155 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Arc segmentation benchmark.  Compares the chord end points that mc_arc()
+// generates, using mc_arc_segments() and ArcRotation, with a copy of the
+// previous implementation, which used a third order small angle approximation
+// for the rotation increments and cosf()/sinf() for every correction.  Nothing
+// is sent to the planner; only the generation of the end points is timed.
+//
+// Two sets of arcs are generated:
+//   pocket  - the same 90 degree corner arc over and over, as in pocketing
+//             and engraving code, so the cached values always match.
+//   varied  - arcs of many radii and angles, so the caches never match.
+//
+// The radial error is the largest distance of a chord end point from the
+// circle, computed in double precision.  It does not include the chord error,
+// which is set by arc_tolerance_mm and is the same for both implementations.
+
+#include "src/Machine/MachineConfig.h"
+#include "src/MotionControl.h"
+#include "Sim.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    const uint32_t n_arcs = 20000;
+
+    struct Arc {
+        float radius;
+        float start_angle;
+        float angular_travel;
+    };
+
+    Arc pocket_arc(uint32_t n) { return { 5.0f, float(M_PI / 2) * (n & 3), float(M_PI / 2) }; }
+
+    Arc varied_arc(uint32_t n) {
+        // A fixed pseudo-random sequence, so runs are comparable.
+        uint32_t h = n * 2654435761u;
+        return { 0.5f + (h % 1000) * 0.05f, (h >> 10) % 628 * 0.01f, 0.1f + (h >> 20) % 600 * 0.01f };
+    }
+
+    struct Path {
+        const char* name;
+        Arc (*arc)(uint32_t n);
+    };
+
+    const Path paths[] = {
+        { "pocket", pocket_arc },
+        { "varied", varied_arc },
+    };
+
+    struct Result {
+        uint32_t segments  = 0;
+        double   max_error = 0.0;
+    };
+
+    void check(const Arc& arc, const float* radii, Result& result) {
+        double error     = fabs(hypot(double(radii[0]), double(radii[1])) - arc.radius);
+        result.max_error = fmax(result.max_error, error);
+    }
+
+    // The arc segmentation of mc_arc() before mc_arc_segments() and ArcRotation.
+    template <bool measure>
+    void reference(const Arc& arc, Result& result, float* sink) {
+        float    radii[2] = { arc.radius * cosf(arc.start_angle), arc.radius * sinf(arc.start_angle) };
+        float    offset[2] = { -radii[0], -radii[1] };
+        float    tolerance = config->_arcTolerance;
+        uint16_t segments  = uint16_t(
+            floorf(fabsf(0.5 * arc.angular_travel * arc.radius) / sqrtf(tolerance * (2 * arc.radius - tolerance))));
+        if (!segments) {
+            return;
+        }
+        float theta_per_segment = arc.angular_travel / segments;
+        float cos_T             = 2.0f - theta_per_segment * theta_per_segment;
+        float sin_T             = theta_per_segment * 0.16666667f * (cos_T + 4.0f);
+        cos_T *= 0.5;
+        size_t count = 0;
+        for (uint16_t i = 1; i < segments; i++) {
+            if (count < N_ARC_CORRECTION) {
+                float ri = radii[0] * sin_T + radii[1] * cos_T;
+                radii[0] = radii[0] * cos_T - radii[1] * sin_T;
+                radii[1] = ri;
+                count++;
+            } else {
+                float cos_Ti = cosf(i * theta_per_segment);
+                float sin_Ti = sinf(i * theta_per_segment);
+                radii[0]     = -offset[0] * cos_Ti + offset[1] * sin_Ti;
+                radii[1]     = -offset[0] * sin_Ti - offset[1] * cos_Ti;
+                count        = 0;
+            }
+            sink[0] += radii[0];
+            sink[1] += radii[1];
+            if (measure) {
+                check(arc, radii, result);
+            }
+        }
+        result.segments += segments;
+    }
+
+    template <bool measure>
+    void current(const Arc& arc, Result& result, float* sink) {
+        float    radii[2] = { arc.radius * cosf(arc.start_angle), arc.radius * sinf(arc.start_angle) };
+        uint16_t segments = mc_arc_segments(arc.radius, arc.angular_travel);
+        if (!segments) {
+            return;
+        }
+        ArcRotation rotation(radii, arc.angular_travel / segments);
+        for (uint16_t i = 1; i < segments; i++) {
+            rotation.step(i, radii);
+            sink[0] += radii[0];
+            sink[1] += radii[1];
+            if (measure) {
+                check(arc, radii, result);
+            }
+        }
+        result.segments += segments;
+    }
+
+    typedef void (*Segmenter)(const Arc& arc, Result& result, float* sink);
+
+    // Returns segments per second, and the radial error from a separate pass so
+    // that the error computation is not timed.
+    double bench(const Path& path, Segmenter timed, Segmenter measured, Result& result) {
+        float sink[2] = {};
+        auto  start   = std::chrono::steady_clock::now();
+        for (uint32_t n = 0; n < n_arcs; ++n) {
+            timed(path.arc(n), result, sink);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (sink[0] == 12345.0f) {  // Keeps the compiler from discarding the work
+            printf(" ");
+        }
+
+        Result errors;
+        for (uint32_t n = 0; n < n_arcs; ++n) {
+            measured(path.arc(n), errors, sink);
+        }
+        result.max_error = errors.max_error;
+        return result.segments / elapsed;
+    }
+}
+
+void Sim::arcBenchmark() {
+    printf("arc segmentation (tolerance %g mm, %u arcs per path)\n", config->_arcTolerance, n_arcs);
+    printf("  %-8s %10s %14s %14s %12s %12s\n", "path", "segments", "ref seg/s", "new seg/s", "ref err mm", "new err mm");
+    for (auto& path : paths) {
+        Result ref, cur;
+        double ref_rate = bench(path, reference<false>, reference<true>, ref);
+        double cur_rate = bench(path, current<false>, current<true>, cur);
+        printf("  %-8s %10u %14.0f %14.0f %12.2e %12.2e\n", path.name, cur.segments, ref_rate, cur_rate, ref.max_error, cur.max_error);
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Compiler for G-code jobs.  Each line is split into words by the same
+// collapseGCode() and gc_split_words() that the firmware runs, and written
+// in the format described in CompiledGCode.h.  Lines that the firmware must
+// see as text are written as text, and lines with nothing to run are left out.
+
+#include "src/Channel.h"
+#include "src/CompiledGCode.h"
+#include "src/GCode.h"
+#include "src/Logging.h"
+#include "Sim.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+    // $ and [ESPxxx] commands go to the settings parser, and (MSG comments
+    // are printed when the line runs, so those lines are kept as text.
+    bool needsText(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first != std::string::npos && (text[first] == '$' || text[first] == '[')) {
+            return true;
+        }
+        return text.find('(') != std::string::npos && text.find("MSG") != std::string::npos;
+    }
+}
+
+bool Sim::compileFile(const char* in_path, const char* out_path) {
+    std::ifstream in(in_path, std::ios::binary);
+    if (!in) {
+        log_error("Cannot open " << in_path);
+        return false;
+    }
+    FILE* out = fopen(out_path, "wb");
+    if (!out) {
+        log_error("Cannot create " << out_path);
+        return false;
+    }
+
+    uint8_t header[CompiledGCode::headerSize];
+    memcpy(header, CompiledGCode::magic, 4);
+    header[4] = CompiledGCode::version;
+    fwrite(header, 1, sizeof(header), out);
+
+    size_t   in_bytes    = 0;
+    size_t   out_bytes   = sizeof(header);
+    uint32_t line_number = 0;
+    uint32_t blocks      = 0;
+    uint32_t texts       = 0;
+    bool     ok          = true;
+
+    std::string text;
+    char        line[Channel::maxLine + 1];
+    gc_word_t   words[CompiledGCode::maxWords];
+    uint8_t     record[CompiledGCode::recordSize + 1 + Channel::maxLine];
+    while (std::getline(in, text)) {
+        ++line_number;
+        in_bytes += text.length() + 1;
+        if (text.length() && text.back() == '\r') {
+            text.pop_back();
+        }
+        // InputFile would stop the job here
+        if (text.length() > Channel::maxLine) {
+            log_error(in_path << " line " << line_number << " is too long");
+            ok = false;
+            break;
+        }
+
+        CompiledGCode::putUint32(line_number, record);
+        size_t length = CompiledGCode::recordSize;
+
+        size_t n_words = 0;
+        bool   asText  = needsText(text);
+        if (!asText) {
+            strcpy(line, text.c_str());
+            collapseGCode(line);
+            if (!*line) {
+                continue;  // Nothing to run
+            }
+            // A line with errors is left for the firmware to report
+            asText = gc_split_words(line, words, CompiledGCode::maxWords, n_words) != Error::Ok;
+        }
+
+        if (asText) {
+            record[4]        = CompiledGCode::textRecord;
+            record[length++] = uint8_t(text.length());
+            memcpy(record + length, text.c_str(), text.length());
+            length += text.length();
+            ++texts;
+        } else {
+            record[4] = uint8_t(n_words);
+            length += CompiledGCode::packWords(words, n_words, record + length);
+            ++blocks;
+        }
+        fwrite(record, 1, length, out);
+        out_bytes += length;
+    }
+    fclose(out);
+
+    printf("%s -> %s\n", in_path, out_path);
+    printf("  lines            %10u\n", line_number);
+    printf("  compiled blocks  %10u\n", blocks);
+    printf("  text lines       %10u\n", texts);
+    printf("  size             %10zu -> %zu bytes (%.2fx)\n", in_bytes, out_bytes, out_bytes ? double(in_bytes) / out_bytes : 0.0);
+    fflush(stdout);
+    return ok;
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Planner benchmark.  Measures the cost of plan_buffer_line() per appended
+// block for a range of planner buffer sizes.  The steppers do not run; the
+// buffer is kept full by discarding the oldest block before each append, which
+// is what the planner sees in steady state while streaming a long job.
+//
+// X and Y are set to 1000 steps/mm and 20000 mm/min for the duration of the
+// benchmark so that the results do not depend on the machine configuration.
+// Two paths are planned:
+//   arc     - 0.05 mm chords around a 25 mm circle at a feed rate that the
+//             buffer can never reach, so every block sits on the deceleration
+//             ramp to the end of the buffer.  This is the planner worst case.
+//   raster  - 2 mm strokes with right angle turns.  Junction limits cap the
+//             entry speeds, so most of the buffer is already optimal.
+
+#include "src/Machine/MachineConfig.h"
+#include "src/Planner.h"
+#include "Sim.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    const uint32_t sizes[] = { 16, 32, 64, 128, 255 };
+    const uint32_t appends = 20000;
+
+    struct Path {
+        const char* name;
+        void (*point)(uint32_t n, float* target);
+        float feed_rate;
+    };
+
+    void arc_point(uint32_t n, float* target) {
+        const float radius = 25.0f;
+        const float step   = 0.05f / radius;
+        target[X_AXIS]     = radius * cosf(n * step);
+        target[Y_AXIS]     = radius * sinf(n * step);
+    }
+
+    void raster_point(uint32_t n, float* target) {
+        // Each stroke is followed by a short step over, making a square wave.
+        target[X_AXIS] = (((n + 1) / 2) & 1) ? 2.0f : 0.0f;
+        target[Y_AXIS] = 0.1f * (n / 2);
+    }
+
+    const Path paths[] = {
+        { "arc", arc_point, 20000.0f },
+        { "raster", raster_point, 3000.0f },
+    };
+
+    double bench(const Path& path, uint32_t planner_blocks) {
+        config->_planner_blocks = planner_blocks;
+        plan_init();
+        plan_reset();
+        plan_sync_position();
+
+        plan_line_data_t pl_data = {};
+        pl_data.feed_rate        = path.feed_rate;
+        float target[MAX_N_AXIS] = {};
+
+        uint32_t n = 0;
+        while (!plan_check_full_buffer()) {
+            path.point(++n, target);
+            plan_buffer_line(target, &pl_data);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < appends; ++i) {
+            plan_discard_current_block();
+            path.point(++n, target);
+            plan_buffer_line(target, &pl_data);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / appends;
+    }
+}
+
+void Sim::plannerBenchmark() {
+    auto  planner_blocks = config->_planner_blocks;
+    auto  x              = config->_axes->_axis[X_AXIS];
+    auto  y              = config->_axes->_axis[Y_AXIS];
+    float x_steps_per_mm = x->_stepsPerMm;
+    float y_steps_per_mm = y->_stepsPerMm;
+    float x_max_rate     = x->_maxRate;
+    float y_max_rate     = y->_maxRate;
+
+    x->_stepsPerMm = y->_stepsPerMm = 1000.0f;
+    x->_maxRate = y->_maxRate = 20000.0f;
+
+    printf("planner cost per appended block (ns)\n");
+    printf("  %-8s", "blocks");
+    for (auto& path : paths) {
+        printf("%10s", path.name);
+    }
+    printf("\n");
+    for (auto size : sizes) {
+        printf("  %-8u", size);
+        for (auto& path : paths) {
+            printf("%10.0f", bench(path, size));
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+
+    x->_stepsPerMm          = x_steps_per_mm;
+    y->_stepsPerMm          = y_steps_per_mm;
+    x->_maxRate             = x_max_rate;
+    y->_maxRate             = y_max_rate;
+    config->_planner_blocks = planner_blocks;
+    plan_init();
+    plan_reset();
+    plan_sync_position();
+}
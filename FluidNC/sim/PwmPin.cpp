@@ -0,0 +1,24 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host PWM driver for the simulator.  The duty cycle is only recorded
+// as a pin level, high for any nonzero duty.
+
+#include "Driver/PwmPin.h"
+#include "Driver/fluidnc_gpio.h"
+
+static const uint32_t pwm_precision = 10;
+
+PwmPin::PwmPin(Pin& pin, uint32_t frequency) : _frequency(frequency) {
+    _gpio    = pin.getNative(Pin::Capabilities::PWM);
+    _period  = (1 << pwm_precision) - 1;
+    _channel = -1;
+}
+
+void PwmPin::setDuty(uint32_t duty) {
+    gpio_write(_gpio, duty != 0);
+}
+
+PwmPin::~PwmPin() {
+    gpio_write(_gpio, false);
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Status report benchmark.  Builds realtime status reports, and then telemetry
+// frames, as a channel with auto reporting would, into a channel that discards
+// them, and prints for each:
+//   reports/s - reports built per second
+//   allocs    - heap allocations per report
+//   bytes     - bytes allocated per report
+//   length    - characters per report
+//
+// The reports are built with the machine idle, so they have the position,
+// feed and speed, and every few reports the WCO and override fields.
+// Allocations are counted by replacing the global operator new while the
+// benchmark runs.
+
+#include "src/Channel.h"
+#include "src/Report.h"
+#include "src/Telemetry.h"
+#include "Sim.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    const uint32_t n_reports = 200000;
+
+    std::atomic<bool>     counting { false };
+    std::atomic<uint64_t> allocations { 0 };
+    std::atomic<uint64_t> allocated { 0 };
+
+    class NullChannel : public Channel {
+    public:
+        uint64_t _chars = 0;
+
+        NullChannel() : Channel("bench") {}
+
+        int    available() override { return 0; }
+        int    read() override { return -1; }
+        int    peek() override { return -1; }
+        size_t write(uint8_t c) override {
+            ++_chars;
+            return 1;
+        }
+    };
+}
+
+void* operator new(size_t size) {
+    if (counting) {
+        ++allocations;
+        allocated += size;
+    }
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+template <typename Report>
+static void run(const char* name, Report report) {
+    NullChannel channel;
+    report(channel);  // Warm up
+
+    channel._chars = 0;
+    allocations    = 0;
+    allocated      = 0;
+    counting       = true;
+    auto start     = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n_reports; ++i) {
+        report(channel);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    counting       = false;
+
+    printf("  %-18s %12.0f %10.2f %10.1f %10.1f\n",
+           name,
+           n_reports / elapsed,
+           double(allocations) / n_reports,
+           double(allocated) / n_reports,
+           double(channel._chars) / n_reports);
+}
+
+void Sim::reportBenchmark() {
+    printf("status reports (%u reports)\n", n_reports);
+    printf("  %-18s %12s %10s %10s %10s\n", "", "reports/s", "allocs", "bytes", "length");
+    run("text", [](Channel& channel) { report_realtime_status(channel); });
+
+    Telemetry::Encoder encoder;
+    run("telemetry", [&encoder](Channel& channel) { encoder.report(channel); });
+    fflush(stdout);
+}
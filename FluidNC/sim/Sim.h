@@ -0,0 +1,35 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Hooks into the host drivers that the simulator uses for measurement.
+
+#include <cstdint>
+
+namespace Sim {
+    // Simulated time is counted in step timer ticks.  With a speedup of 0 the
+    // timer runs as fast as the host allows, otherwise it is paced so that
+    // simulated time runs that many times faster than wall clock time.
+    void setTimerSpeedup(float speedup);
+
+    uint64_t timerTicks();       // Total simulated time in step timer ticks
+    uint64_t timerInterrupts();  // Number of calls to the step timer callback
+    uint32_t timerFrequency();
+
+    // Prints the planning cost per appended block for a range of planner
+    // buffer sizes.  See PlannerBench.cpp
+    void plannerBenchmark();
+
+    // Prints the speed and accuracy of arc segmentation against the
+    // previous implementation.  See ArcBench.cpp
+    void arcBenchmark();
+
+    // Prints the speed and heap use of building realtime status reports and telemetry frames.
+    // See ReportBench.cpp
+    void reportBenchmark();
+
+    // Writes a compiled job for a G-code file and prints the sizes.  Returns
+    // false if the file cannot be compiled.  See Compiler.cpp
+    bool compileFile(const char* in_path, const char* out_path);
+}
@@ -0,0 +1,284 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host simulator for the motion pipeline.  G-code files are run through the
+// real parser, planner, motion control and segment generator, while the step
+// timer is simulated by a host thread (see StepTimer.cpp).  At the end of each
+// file the simulator reports planner and segment throughput, the number of
+// step timer interrupts, the segment buffer starvation statistics (see $Stats)
+// and the simulated machine time.
+//
+// Usage: fluidnc_sim [--config machine.yaml] [--speedup N] [--quiet] [--motion-task] [--bench-planner] [--bench-arcs]
+//                    [--bench-report] file.nc ...
+//        fluidnc_sim --compile in.nc out.gcb
+//
+// With --speedup 0 (the default) the step timer runs as fast as the host
+// allows, which measures how quickly the planner and segment generator can
+// produce work.  A positive value paces simulated time at N times real time,
+// which shows whether prep keeps up with the stepping at that rate.
+//
+// --motion-task starts the segment preparation task, as on the controller, so
+// that segments are prepared by both it and the main loop.
+//
+// --bench-planner measures the planning cost per block for a range of planner
+// buffer sizes before running any files.  See PlannerBench.cpp
+//
+// --bench-arcs compares the speed and accuracy of arc segmentation with the
+// previous implementation.  See ArcBench.cpp
+//
+// --bench-report measures the speed and heap use of building status reports and
+// telemetry frames.  See ReportBench.cpp
+//
+// --compile in.nc out.gcb writes a compiled job (see CompiledGCode.h) and
+// exits.  Compiled jobs can be run like G-code files.
+
+#include "src/Machine/MachineConfig.h"
+#include "src/Channel.h"
+#include "src/InputFile.h"
+#include "src/Limits.h"
+#include "src/Planner.h"
+#include "src/Protocol.h"
+#include "src/Report.h"
+#include "src/Serial.h"
+#include "src/Settings.h"
+#include "src/StartupLog.h"
+#include "src/Stepper.h"
+#include "src/System.h"
+#include "src/UartChannel.h"
+#include "Driver/localfs.h"
+#include "Sim.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern void make_user_commands();
+
+// Collects the responses to the lines that the simulator sends.
+class SimChannel : public Channel {
+public:
+    uint32_t _lines      = 0;
+    uint32_t _errors     = 0;
+    uint32_t _lineNumber = 0;  // Line of the file that is running
+    bool     _quiet      = false;
+
+    SimChannel() : Channel("sim") {}
+
+    int    available() override { return 0; }
+    int    read() override { return -1; }
+    int    peek() override { return -1; }
+    size_t write(uint8_t c) override {
+        if (!_quiet) {
+            putchar(c);
+        }
+        return 1;
+    }
+
+    void ack(Error status) override {
+        ++_lines;
+        if (status != Error::Ok) {
+            ++_errors;
+            log_error("Line " << _lineNumber << ": " << errorString(status));
+        }
+    }
+};
+
+static double cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool read_file(const char* path, std::string& contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    contents = ss.str();
+    return true;
+}
+
+static void init_machine(const char* config_path) {
+    init_log_lines();
+    timing_init();
+    uartInit();
+    StartupLog::init();
+    allChannels.init();
+    protocol_init();
+    settings_init();
+    localfs_mount();
+
+    std::string yaml;
+    if (config_path && !read_file(config_path, yaml)) {
+        log_error("Cannot read " << config_path);
+    }
+    if (yaml.empty() || !MachineConfig::load_yaml(yaml)) {
+        log_info("Using default configuration");
+        MachineConfig::load_yaml("name: Simulator\nboard: None\n");
+    }
+
+    make_user_commands();
+
+    config->_stepping->init();
+    plan_init();
+    config->_userOutputs->init();
+    config->_axes->init();
+    config->_control->init();
+    config->_kinematics->init();
+    limits_init();
+
+    for (auto s : config->_spindles) {
+        s->init();
+    }
+    Spindles::Spindle::switchSpindle(0, config->_spindles, spindle);
+    config->_coolant->init();
+    config->_probe->init();
+
+    allChannels.ready();
+    allChannels.deregistration(&startupLog);
+
+    protocol_send_event(&startEvent);
+    protocol_execute_realtime();
+}
+
+static void run_line(char* line, SimChannel& channel) {
+    Error status = execute_line(line, channel, WebUI::AuthenticationLevel::LEVEL_ADMIN);
+    channel.ack(status);
+
+    // Same as the body of protocol_main_loop()
+    protocol_auto_cycle_start();
+    protocol_execute_realtime();
+}
+
+static void run_file(const char* path, SimChannel& channel) {
+    // Files are read through InputFile, as file jobs are, so compiled jobs run too.
+    // An absolute path keeps it from being taken as a path on the local filesystem.
+    InputFile* file;
+    try {
+        file = new InputFile("", std::filesystem::absolute(path).c_str(), WebUI::AuthenticationLevel::LEVEL_ADMIN, channel, true);
+    } catch (...) {
+        log_error("Cannot open " << path);
+        return;
+    }
+
+    uint32_t start_blocks   = Stepper::prepped_blocks;
+    uint32_t start_segments = Stepper::prepped_segments;
+    uint64_t start_ticks    = Sim::timerTicks();
+    uint64_t start_isrs     = Sim::timerInterrupts();
+    uint32_t start_lines    = channel._lines;
+    double   start_cpu      = cpu_seconds();
+    Stepper::reset_stats();
+    auto     start_wall     = std::chrono::steady_clock::now();
+
+    char  line[Channel::maxLine + 1];
+    Error status;
+    while ((status = file->readLine(line, Channel::maxLine)) == Error::Ok && !sys.abort) {
+        channel._lineNumber = file->getLineNumber();
+        run_line(line, channel);
+    }
+    if (status != Error::Ok && status != Error::Eof) {
+        log_error(path << " line " << file->getLineNumber() << ": " << errorString(status));
+    }
+    delete file;
+    protocol_buffer_synchronize();
+
+    double wall     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_wall).count();
+    double cpu      = cpu_seconds() - start_cpu;
+    auto   blocks   = Stepper::prepped_blocks - start_blocks;
+    auto   segments = Stepper::prepped_segments - start_segments;
+    auto   isrs     = Sim::timerInterrupts() - start_isrs;
+    double machine  = double(Sim::timerTicks() - start_ticks) / Sim::timerFrequency();
+
+    printf("%s\n", path);
+    printf("  lines            %10u\n", channel._lines - start_lines);
+    printf("  planner blocks   %10u  %12.0f blocks/s\n", blocks, blocks / wall);
+    printf("  step segments    %10u  %12.0f segments/s\n", segments, segments / wall);
+    printf("  timer interrupts %10llu\n", (unsigned long long)isrs);
+    printf("  segment underruns%10u  min fill %u\n", Stepper::stats.underruns.load(), Stepper::min_segment_fill());
+    printf("  planner starved  %10.3f s\n", Stepper::starved_seconds());
+    printf("  machine time     %10.3f s\n", machine);
+    printf("  wall time        %10.3f s  (%.1fx real time)\n", wall, wall > 0 ? machine / wall : 0.0);
+    printf("  cpu time         %10.3f s\n", cpu);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    const char*              config_path = nullptr;
+    std::vector<const char*> files;
+    SimChannel               channel;
+    bool                     bench_planner = false;
+    bool                     bench_arcs    = false;
+    bool                     bench_report  = false;
+    bool                     motion_task   = false;
+    const char*              compile_in    = nullptr;
+    const char*              compile_out   = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--config") && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (!strcmp(argv[i], "--speedup") && i + 1 < argc) {
+            Sim::setTimerSpeedup(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--quiet")) {
+            channel._quiet = true;
+        } else if (!strcmp(argv[i], "--motion-task")) {
+            motion_task = true;
+        } else if (!strcmp(argv[i], "--bench-planner")) {
+            bench_planner = true;
+        } else if (!strcmp(argv[i], "--bench-arcs")) {
+            bench_arcs = true;
+        } else if (!strcmp(argv[i], "--bench-report")) {
+            bench_report = true;
+        } else if (!strcmp(argv[i], "--compile") && i + 2 < argc) {
+            compile_in  = argv[++i];
+            compile_out = argv[++i];
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty() && !bench_planner && !bench_arcs && !bench_report && !compile_in) {
+        fprintf(stderr,
+                "Usage: %s [--config machine.yaml] [--speedup N] [--quiet] [--motion-task] [--bench-planner] [--bench-arcs]\n"
+                "          [--bench-report] file.nc ...\n"
+                "       %s --compile in.nc out.gcb\n",
+                argv[0],
+                argv[0]);
+        return 1;
+    }
+
+    init_machine(config_path);
+    if (compile_in) {
+        return Sim::compileFile(compile_in, compile_out) ? 0 : 2;
+    }
+    if (motion_task) {
+        start_motion_task();
+    }
+
+    if (sys.state == State::Alarm) {
+        char unlock[] = "$X";
+        run_line(unlock, channel);
+    }
+
+    if (bench_planner) {
+        Sim::plannerBenchmark();
+    }
+    if (bench_arcs) {
+        Sim::arcBenchmark();
+    }
+    if (bench_report) {
+        Sim::reportBenchmark();
+    }
+
+    for (auto file : files) {
+        run_file(file, channel);
+    }
+    return channel._errors ? 2 : 0;
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host step timer for the simulator.  A thread stands in for the timer
+// interrupt.  Each call to the callback advances a simulated clock by the
+// alarm period that is in effect, mimicking the auto-reload behavior of
+// the ESP32 timer.
+
+#include "Driver/StepTimer.h"
+#include "Sim.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static uint32_t timer_frequency;
+static bool (*timer_isr_callback)(void);
+
+static std::atomic<uint32_t> alarm_ticks;
+static std::atomic<uint32_t> starts;
+static std::atomic<bool>     running;
+static std::atomic<uint64_t> sim_ticks;
+static std::atomic<uint64_t> interrupts;
+static float                 speedup = 0;
+
+// The timer thread is never joined, so these are never destroyed; destroying
+// a condition variable that a thread is waiting on would hang at exit.
+static std::mutex&              timer_mutex = *new std::mutex;
+static std::condition_variable& timer_cv    = *new std::condition_variable;
+
+static void timer_thread() {
+    using clock = std::chrono::steady_clock;
+
+    while (true) {
+        uint32_t generation;
+        {
+            std::unique_lock<std::mutex> lock(timer_mutex);
+            timer_cv.wait(lock, [] { return running.load(); });
+            generation = starts;
+        }
+
+        auto     pace_start  = clock::now();
+        uint64_t pace_origin = sim_ticks;
+
+        while (running) {
+            bool again = timer_isr_callback();
+            ++interrupts;
+            sim_ticks += alarm_ticks;
+            if (!again) {
+                // The alarm is not re-armed, unless the timer was restarted
+                // while the callback was running.
+                if (starts == generation) {
+                    running = false;
+                }
+                break;
+            }
+            if (speedup > 0) {
+                auto elapsed = std::chrono::duration<double>((sim_ticks - pace_origin) / (double(timer_frequency) * speedup));
+                auto target  = pace_start + std::chrono::duration_cast<clock::duration>(elapsed);
+                // Sleeping rather than spinning leaves the CPU to the prep
+                // thread on single-core hosts.  The target is absolute, so
+                // running up to a millisecond early or late does not drift.
+                if (target - clock::now() > std::chrono::milliseconds(1)) {
+                    std::this_thread::sleep_until(target);
+                }
+            }
+        }
+    }
+}
+
+void stepTimerStart() {
+    alarm_ticks = 10;  // Interrupt very soon to start the stepping
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        ++starts;
+        running = true;
+    }
+    timer_cv.notify_one();
+}
+
+void stepTimerSetTicks(uint32_t ticks) {
+    alarm_ticks = ticks;
+}
+
+void stepTimerStop() {
+    running = false;
+}
+
+void stepTimerInit(uint32_t frequency, bool (*callback)(void)) {
+    timer_frequency    = frequency;
+    timer_isr_callback = callback;
+    running            = false;
+
+    static bool started = false;
+    if (!started) {
+        started = true;
+        std::thread(timer_thread).detach();
+    }
+}
+
+namespace Sim {
+    void setTimerSpeedup(float factor) { speedup = factor; }
+
+    uint64_t timerTicks() { return sim_ticks; }
+    uint64_t timerInterrupts() { return interrupts; }
+    uint32_t timerFrequency() { return timer_frequency; }
+}
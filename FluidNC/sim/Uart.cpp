@@ -0,0 +1,73 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host UART driver for the simulator.  UART 0 is the console, so its
+// output goes to stdout.  Nothing is ever received.
+
+#include "src/Uart.h"
+
+#include <cstdio>
+
+Uart::Uart(int uart_num) : _uart_num(uart_num) {}
+
+void Uart::begin(unsigned long baud, UartData dataBits, UartStop stopBits, UartParity parity) {}
+
+void Uart::begin() {
+    begin(_baud, _dataBits, _stopBits, _parity);
+    config_message("UART", std::to_string(_uart_num).c_str());
+}
+
+int Uart::read() {
+    if (_pushback != -1) {
+        int ret   = _pushback;
+        _pushback = -1;
+        return ret;
+    }
+    return -1;
+}
+
+size_t Uart::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t Uart::write(const uint8_t* buffer, size_t length) {
+    if (_uart_num == 0) {
+        fwrite(buffer, 1, length, stdout);
+    }
+    return length;
+}
+
+size_t Uart::timedReadBytes(char* buffer, size_t len, TickType_t timeout) {
+    return 0;
+}
+
+bool Uart::setHalfDuplex() {
+    return false;
+}
+bool Uart::setPins(int tx_pin, int rx_pin, int rts_pin, int cts_pin) {
+    return false;
+}
+bool Uart::flushTxTimed(TickType_t ticks) {
+    fflush(stdout);
+    return false;
+}
+
+void Uart::config_message(const char* prefix, const char* usage) {
+    log_info(prefix << usage << " Tx:" << _txd_pin.name() << " Rx:" << _rxd_pin.name() << " RTS:" << _rts_pin.name() << " Baud:" << _baud);
+}
+
+int Uart::rx_buffer_available(void) {
+    return 128 - available();
+}
+
+int Uart::peek() {
+    return _pushback;
+}
+
+int Uart::available() {
+    return _pushback != -1;
+}
+
+void Uart::flushRx() {
+    _pushback = -1;
+}
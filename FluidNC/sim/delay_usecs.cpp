@@ -0,0 +1,36 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host version of the CPU cycle counter delays, using a nanosecond clock
+// in place of CCOUNT.
+
+#include "Driver/delay_usecs.h"
+
+#include <chrono>
+
+uint32_t ticks_per_us;
+
+void timing_init() {
+    ticks_per_us = 1000;
+}
+
+void delay_us(int32_t us) {
+    spinUntil(usToEndTicks(us));
+}
+
+int32_t usToCpuTicks(int32_t us) {
+    return us * ticks_per_us;
+}
+
+int32_t usToEndTicks(int32_t us) {
+    return getCpuTicks() + usToCpuTicks(us);
+}
+
+void spinUntil(int32_t endTicks) {
+    while ((getCpuTicks() - endTicks) < 0) {}
+}
+
+int32_t getCpuTicks() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return int32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host GPIO driver for the simulator.  Pin levels are kept in memory;
+// nothing is routed and no input events are generated.
+
+#include "Driver/fluidnc_gpio.h"
+#include "src/Config.h"
+
+#include <atomic>
+
+static const int         n_gpios = 64;
+static std::atomic<bool> _levels[n_gpios];
+static gpio_dispatch_t   _actions[n_gpios];
+static void*             _args[n_gpios];
+
+void gpio_write(pinnum_t pin, bool value) {
+    if (pin < n_gpios) {
+        _levels[pin].store(value, std::memory_order_relaxed);
+    }
+}
+bool gpio_read(pinnum_t pin) {
+    return pin < n_gpios && _levels[pin].load(std::memory_order_relaxed);
+}
+void gpio_mode(pinnum_t pin, bool input, bool output, bool pullup, bool pulldown, bool opendrain) {
+    if (pullup) {
+        gpio_write(pin, true);
+    }
+}
+void gpio_set_interrupt_type(pinnum_t pin, int mode) {}
+void gpio_add_interrupt(pinnum_t pin, int mode, void (*callback)(void*), void* arg) {}
+void gpio_remove_interrupt(pinnum_t pin) {}
+void gpio_route(pinnum_t pin, uint32_t signal) {}
+
+void gpio_set_action(int gpio_num, gpio_dispatch_t action, void* arg, bool invert) {
+    if (gpio_num < n_gpios) {
+        _actions[gpio_num] = action;
+        _args[gpio_num]    = arg;
+    }
+}
+void gpio_clear_action(int gpio_num) {
+    if (gpio_num < n_gpios) {
+        _actions[gpio_num] = nullptr;
+        _args[gpio_num]    = nullptr;
+    }
+}
+void poll_gpios() {}
+
+void gpio_dump(Print& out) {
+    for (int gpio = 0; gpio < n_gpios; ++gpio) {
+        if (_actions[gpio]) {
+            out << "gpio." << gpio << " " << (gpio_read(gpio) ? "1" : "0") << '\n';
+        }
+    }
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// The simulator has no flash partitions.  The local filesystem is
+// reported as mounted so that path handling works, but the simulator
+// reads its inputs directly from host paths.
+
+#include "Driver/localfs.h"
+#include "Driver/spiffs.h"
+#include "Driver/littlefs.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+const char* localfsName    = NULL;
+const char* littlefs_label = littlefsName;
+
+bool spiffs_format(const char* partition_label) {
+    return true;
+}
+bool spiffs_mount(const char* label, bool format) {
+    return true;
+}
+void spiffs_unmount() {}
+
+bool littlefs_format(const char* partition_label) {
+    return false;
+}
+bool littlefs_mount(const char* label, bool format) {
+    return false;
+}
+void littlefs_unmount() {}
+
+bool localfs_mount() {
+    localfsName = defaultLocalfsName;
+    return false;
+}
+void localfs_unmount() {
+    localfsName = NULL;
+}
+bool localfs_format(const char* fsname) {
+    return false;
+}
+
+uint64_t localfs_size() {
+    return 0;
+}
+
+const char* canonicalPath(const char* filename, const char* defaultFs) {
+    static char path[128];
+    if (*filename == '/') {
+        strncpy(path, filename, sizeof(path) - 1);
+    } else {
+        snprintf(path, sizeof(path), "/%s/%s", *defaultFs ? defaultFs : localfsName, filename);
+    }
+    return path;
+}
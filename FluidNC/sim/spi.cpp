@@ -0,0 +1,25 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// There is no SPI bus or SD card in the simulator.
+
+#include "Driver/spi.h"
+#include "Driver/sdspi.h"
+
+bool spi_init_bus(pinnum_t sck_pin, pinnum_t miso_pin, pinnum_t mosi_pin, bool dma) {
+    return false;
+}
+
+void spi_deinit_bus() {}
+
+bool sd_init_slot(uint32_t freq_hz, int cs_pin, int cd_pin, int wp_pin) {
+    return false;
+}
+
+std::error_code sd_mount(int max_files) {
+    return std::make_error_code(std::errc::no_such_device);
+}
+
+void sd_unmount() {}
+
+void sd_deinit_slot() {}
@@ -7,14 +7,14 @@
 #include "RealtimeCmd.h"            // execute_realtime_command
 #include "Limits.h"
 #include "Logging.h"
+#include "CompiledGCode.h"          // CompiledGCode::blockMarker
+#include <cstring>
 #include <string_view>
 
 void Channel::flushRx() {
     _linelen   = 0;
     _lastWasCR = false;
-    while (_queue.size()) {
-        _queue.pop();
-    }
+    _queue.pop(_queue.count());
 }
 
 bool Channel::lineComplete(char* line, char ch) {
@@ -49,6 +49,10 @@ bool Channel::lineComplete(char* line, char ch) {
         _linelen = 0;
         return true;
     }
+    if (ch == CompiledGCode::blockMarker) {
+        // Only InputFile may start a line with it
+        return false;
+    }
     if (ch == '\b') {
         // Simple editing for interactive input - backspace erases
         if (_linelen) {
@@ -70,13 +74,20 @@ bool Channel::lineComplete(char* line, char ch) {
 uint32_t Channel::setReportInterval(uint32_t ms) {
     uint32_t actual = ms;
     if (actual) {
-        actual = std::max(actual, uint32_t(50));
+        actual = std::max(actual, _telemetry.enabled() ? Telemetry::minInterval : uint32_t(50));
     }
     _reportInterval = actual;
     _nextReportTime = int32_t(xTaskGetTickCount());
     _lastTool       = 255;  // Force GCodeState report
     return actual;
 }
+void Channel::setTelemetry(bool on) {
+    _telemetry.enable(on);
+    if (!on && _reportInterval) {
+        // The text reports have a longer minimum interval
+        setReportInterval(_reportInterval);
+    }
+}
 static bool motionState() {
     return sys.state == State::Cycle || sys.state == State::Homing || sys.state == State::Jog;
 }
@@ -118,7 +129,11 @@ void Channel::autoReport() {
             _lastPinString = report_pin_string;
 
             _nextReportTime = xTaskGetTickCount() + _reportInterval;
-            report_realtime_status(*this);
+            if (_telemetry.enabled()) {
+                _telemetry.report(*this);
+            } else {
+                report_realtime_status(*this);
+            }
         }
         if (_reportNgc != CoordIndex::End) {
             report_ngc_coord(_reportNgc, *this);
@@ -175,41 +190,172 @@ void Channel::handleRealtimeCharacter(uint8_t ch) {
     execute_realtime_command(static_cast<Cmd>(cmd), *this);
 }
 
-void Channel::push(uint8_t byte) {
-    if (is_realtime_command(byte)) {
-        handleRealtimeCharacter(byte);
+// Adds characters to the receive ring, returning false if some did not fit
+bool Channel::queueBytes(const uint8_t* data, size_t length) {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    if (!_queue.capacity()) {
+        // The consumer does not touch the storage of an empty ring
+        _queue.init(_rxWindow);
+    }
+    if (_queue.write(data, length) == length) {
+        _overflowed = false;
+        return true;
+    }
+    // The sender did not respect rx_buffer_available()
+    if (!_overflowed) {
+        log_error(name() << " receive buffer overflow");
+        _overflowed = true;
+    }
+    return false;
+}
+
+void Channel::push(const uint8_t* data, size_t length) {
+    while (length) {
+        // Queue everything up to the next realtime character in one copy
+        size_t run = 0;
+        while (run < length && !is_realtime_command(data[run])) {
+            ++run;
+        }
+        queueBytes(data, run);
+        data += run;
+        length -= run;
+        if (length) {
+            handleRealtimeCharacter(*data++);
+            --length;
+        }
+    }
+}
+
+// The number of characters at the start of data that lineComplete() would just append to the line
+static size_t plainSpan(const char* data, size_t length) {
+    const char* end = static_cast<const char*>(memchr(data, '\n', length));
+    if (end) {
+        length = end - data;
+    }
+    for (char special : { '\r', '\b', CompiledGCode::blockMarker }) {
+        end = static_cast<const char*>(memchr(data, special, length));
+        if (end) {
+            length = end - data;
+        }
+    }
+    return length;
+}
+
+// Takes queued characters into the line, a contiguous run of the ring at a time, returning true
+// when the line is complete.  Realtime characters were taken out when the characters were queued.
+bool Channel::lineFromQueue(char* line) {
+    if (_queue.capacity() != _rxWindow && _queue.empty()) {
+        // Resize for a new receive window.  The producer may be between its check and its write.
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        if (_queue.capacity() && _queue.empty()) {
+            _queue.init(_rxWindow);
+        }
+    }
+    uint32_t run;
+    while ((run = _queue.contiguous()) != 0) {
+        const char* data  = reinterpret_cast<const char*>(&_queue.front());
+        size_t      plain = plainSpan(data, run);
+        if (plain) {
+            // Characters that do not fit are dropped, as lineComplete() drops them
+            size_t n = std::min(plain, Channel::maxLine - 1 - _linelen);
+            memcpy(_line + _linelen, data, n);
+            _linelen += n;
+            _lastWasCR = false;
+            _queue.pop(plain);
+            continue;
+        }
+        char ch = *data;
+        _queue.pop(1);
+        if (lineComplete(line, ch)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Channel::setRxWindow(uint32_t bytes) {
+    if (bytes < minRxWindow) {
+        bytes = minRxWindow;
+    } else if (bytes > maxRxWindow) {
+        bytes = maxRxWindow;
+    }
+    _rxWindow = bytes;
+    return _rxWindow;
+}
+
+void Channel::setStreaming(bool on) {
+    std::lock_guard<std::mutex> lock(_ackMutex);
+    if (on) {
+        if (_rxWindow < streamingRxWindow) {
+            setRxWindow(streamingRxWindow);
+        }
     } else {
-        _queue.push(byte);
+        sendAcks();
     }
+    _streaming = on;
+}
+
+// Ack batches are suffixes of this
+static const char okBatch[] = "ok\nok\nok\nok\nok\nok\nok\nok\nok\nok\nok\nok\nok\nok\nok\nok";
+
+// Sends the pending acks as one message.  _ackMutex must be held.
+void Channel::sendAcks() {
+    static_assert(sizeof(okBatch) == maxAckBatch * 3, "okBatch must have maxAckBatch oks");
+    if (!_pendingAcks) {
+        return;
+    }
+    const char* oks = okBatch + (maxAckBatch - _pendingAcks) * 3;
+    _pendingAcks    = 0;
+    if (outputTask) {
+        queue_message({ this, (void*)oks, MsgLevelNone, LogKind::Fixed });
+    } else {
+        print_msg(MsgLevelNone, oks);
+    }
+}
+
+// Output to a streaming channel must not pass the acks for the lines before it.  This sends the
+// pending acks and returns a lock that keeps more acks from being sent until the output is queued.
+// The lock is empty if the channel is not streaming.
+std::unique_lock<std::mutex> Channel::holdAcks() {
+    if (!_streaming) {
+        return {};
+    }
+    std::unique_lock<std::mutex> lock(_ackMutex);
+    sendAcks();
+    return lock;
 }
 
 Channel* Channel::pollLine(char* line) {
     handle();
+    if (line && lineFromQueue(line)) {
+        return this;
+    }
     while (1) {
-        int ch = -1;
-        if (line && _queue.size()) {
-            ch = _queue.front();
-            _queue.pop();
-        } else {
-            ch = read();
-            if (ch < 0) {
-                break;
-            }
-            if (realtimeOkay(ch) && is_realtime_command(ch)) {
-                handleRealtimeCharacter((uint8_t)ch);
-                continue;
-            }
-            if (!line) {
-                _queue.push(ch);
-                continue;
-            }
-            // Fall through if line is non-null and it is not a realtime character
+        int ch = read();
+        if (ch < 0) {
+            break;
+        }
+        if (realtimeOkay(ch) && is_realtime_command(ch)) {
+            handleRealtimeCharacter((uint8_t)ch);
+            continue;
+        }
+        if (!line) {
+            // Keep reading, so that realtime characters behind it are seen
+            uint8_t byte = ch;
+            queueBytes(&byte, 1);
+            continue;
         }
-
         if (lineComplete(line, ch)) {
             return this;
         }
     }
+    if (_streaming) {
+        // Send the held acks once the queued lines are used up, or if they have waited long enough
+        std::lock_guard<std::mutex> lock(_ackMutex);
+        if (_pendingAcks && (line || int32_t(xTaskGetTickCount()) - _firstAck >= ackHoldMs)) {
+            sendAcks();
+        }
+    }
     if (_active) {
         autoReport();
     }
@@ -251,6 +397,16 @@ void Channel::registerEvent(uint8_t code, EventPin* obj) {
 
 void Channel::ack(Error status) {
     if (status == Error::Ok) {
+        if (_streaming) {
+            std::lock_guard<std::mutex> lock(_ackMutex);
+            if (!_pendingAcks++) {
+                _firstAck = xTaskGetTickCount();
+            }
+            if (_pendingAcks == maxAckBatch) {
+                sendAcks();
+            }
+            return;
+        }
         sendLine(MsgLevelNone, "ok");
         return;
     }
@@ -277,48 +433,71 @@ void Channel::print_msg(MsgLevel level, const char* msg) {
 // This is the most efficient form, but it only works
 // with fixed messages.
 void Channel::sendLine(MsgLevel level, const char* line) {
+    auto acks = holdAcks();
     if (outputTask) {
-        LogMessage msg { this, (void*)line, level, false };
-        while (!xQueueSend(message_queue, &msg, 10)) {}
+        queue_message({ this, (void*)line, level, LogKind::Fixed });
     } else {
         print_msg(level, line);
     }
 }
 
-// This overload is used primarily with log_*() where
-// a std::string is dynamically allocated with "new",
-// and then extended to construct the message.  Its
-// pointer is sent to the output task, which sends
-// the message to the output channel and then "delete"s
-// the pointer to reclaim the memory.
-// This form has intermediate efficiency, as the string
-// is allocated once and freed once.
+// This overload is used with log_*() messages that grew
+// too long for a line buffer.  Its pointer is sent to the
+// output task, which sends the message to the output
+// channel and then "delete"s the pointer to reclaim the
+// memory.
 void Channel::sendLine(MsgLevel level, const std::string* line) {
+    auto acks = holdAcks();
     if (outputTask) {
-        LogMessage msg { this, (void*)line, level, true };
-        while (!xQueueSend(message_queue, &msg, 10)) {}
+        if (!queue_message({ this, (void*)line, level, LogKind::String })) {
+            delete line;
+        }
     } else {
         print_msg(level, line->c_str());
         delete line;
     }
 }
 
+// This overload is used primarily with log_*(), which
+// builds the message in a line buffer from the message
+// pool.  The output task releases the buffer after the
+// message is forwarded to the output channel.  Nothing
+// is allocated.
+void Channel::sendLine(MsgLevel level, LogLine* line) {
+    auto acks = holdAcks();
+    if (outputTask) {
+        if (!queue_message({ this, (void*)line, level, LogKind::Pooled })) {
+            LogLine::release(line);
+        }
+    } else {
+        print_msg(level, line->text);
+        LogLine::release(line);
+    }
+}
+
 // This overload is used for many miscellaneous messages
-// where the std::string is allocated in a code block and
+// where the std::string is built in a code block and
 // then extended with various information.  This send_line()
-// copies that string to a newly allocated one and sends that
-// via the std::string* version of send_line().  The original
-// string is freed by the caller sometime after send_line()
-// returns, while the new string is freed by the output task
-// after the message is forwared to the output channel.
-// This is the least efficient form, requiring two strings
-// to be allocated and freed, with an intermediate copy.
-// It is used only rarely.
+// copies that string to a line buffer and sends that via
+// the LogLine* version of send_line().  A string that is
+// too long for a line buffer is copied to a newly
+// allocated one instead.
 void Channel::sendLine(MsgLevel level, const std::string& line) {
-    if (outputTask) {
-        sendLine(level, new std::string(line));
-    } else {
+    if (!outputTask) {
+        auto acks = holdAcks();
         print_msg(level, line.c_str());
+        return;
+    }
+    if (line.length() >= LogLine::size) {
+        ++log_stats.oversize;
+        sendLine(level, new std::string(line));
+        return;
+    }
+    LogLine* pooled = LogLine::alloc();
+    if (pooled) {
+        memcpy(pooled->text, line.c_str(), line.length() + 1);
+        pooled->length = line.length();
+        sendLine(level, pooled);
     }
 }
 
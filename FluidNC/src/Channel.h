@@ -20,6 +20,8 @@
 #include "GCode.h"        // gc_modal_t
 #include "Types.h"        // State
 #include "RealtimeCmd.h"  // Cmd
+#include "SpscRing.h"
+#include "Telemetry.h"    // Telemetry::Encoder
 #include "UTF8.h"
 
 #include "Pins/PinAttributes.h"
@@ -27,7 +29,7 @@
 
 #include <Stream.h>
 #include <freertos/FreeRTOS.h>  // TickType_T
-#include <queue>
+#include <mutex>
 
 class Channel : public Stream {
 private:
@@ -43,9 +45,35 @@ private:
 
     const int timeout = 2000;
 
+    bool _overflowed = false;
+
+    bool queueBytes(const uint8_t* data, size_t length);
+    bool lineFromQueue(char* line);
+
+    // Acks held back by a streaming channel, to be sent together
+    bool       _streaming   = false;
+    uint32_t   _pendingAcks = 0;
+    int32_t    _firstAck    = 0;  // Tick of the oldest pending ack
+    std::mutex _ackMutex;
+
+    void                         sendAcks();
+    std::unique_lock<std::mutex> holdAcks();
+
 public:
     static const int maxLine = 255;
 
+    // The receive window is the size of the ring for received characters that are waiting to be
+    // made into lines, which rx_buffer_available() reports to senders that count characters.
+    static const uint32_t defaultRxWindow   = 1023;
+    static const uint32_t minRxWindow       = 127;
+    static const uint32_t maxRxWindow       = 16383;
+    static const uint32_t streamingRxWindow = 4095;
+
+    // A streaming channel sends the acks for up to maxAckBatch lines as one message, holding
+    // them for up to ackHoldMs while more lines are waiting.
+    static const uint32_t maxAckBatch = 16;
+    static const int32_t  ackHoldMs   = 10;
+
     int _message_level = MsgLevelVerbose;
 
 protected:
@@ -55,11 +83,20 @@ protected:
     bool        _addCR     = false;
     char        _lastWasCR = false;
 
-    std::queue<uint8_t> _queue;
+    // The ring is allocated when the first character is queued, since many channels never queue any.
+    // Characters are queued by push() or by pollLine() with no line, and taken by pollLine() with a
+    // line; the ring allows one of each at a time.  The producer holds _queueMutex while it writes,
+    // so that the consumer can take it to reallocate the ring when it is empty after the receive
+    // window changes.  The consumer never waits for it otherwise.
+    SpscRing<uint8_t> _queue;
+    std::mutex        _queueMutex;
+    uint32_t          _rxWindow = defaultRxWindow;
 
     uint32_t _reportInterval = 0;
     int32_t  _nextReportTime = 0;
 
+    Telemetry::Encoder _telemetry;
+
     gc_modal_t  _lastModal;
     uint8_t     _lastTool;
     float       _lastSpindleSpeed;
@@ -100,15 +137,22 @@ public:
 
     virtual void sendLine(MsgLevel level, const char* line);
     virtual void sendLine(MsgLevel level, const std::string* line);
+    virtual void sendLine(MsgLevel level, LogLine* line);
     virtual void sendLine(MsgLevel level, const std::string& line);
 
     // rx_buffer_available() is the number of bytes that can be sent without overflowing
     // a reception buffer, even if the system is busy.  Channels that can handle external
     // input via an interrupt or other background mechanism should override it to return
     // the remaining space that mechanism has available.
-    // The queue can handle more than 256 characters but we don't want it to get too
-    // large, so we report a limited size.
-    virtual int rx_buffer_available() { return std::max(0, 256 - int(_queue.size())); }
+    virtual int rx_buffer_available() { return (_queue.capacity() ? _queue.capacity() : _rxWindow) - _queue.count(); }
+
+    // The receive window can be changed at any time; it takes effect when the ring is next empty.
+    uint32_t setRxWindow(uint32_t bytes);
+    uint32_t getRxWindow() { return _rxWindow; }
+
+    // In streaming mode the channel has at least streamingRxWindow and batches its acks.
+    void setStreaming(bool on);
+    bool getStreaming() { return _streaming; }
 
     // flushRx() discards any characters that have already been received.  It is used
     // after a reset, so that anything already sent will not be processed.
@@ -149,7 +193,7 @@ public:
 
     int peek() override { return -1; }
     int read() override { return -1; }
-    int available() override { return _queue.size(); }
+    int available() override { return _queue.count(); }
 
     virtual void print_msg(MsgLevel level, const char* msg);
 
@@ -157,20 +201,15 @@ public:
 
     uint32_t     setReportInterval(uint32_t ms);
     uint32_t     getReportInterval() { return _reportInterval; }
+    void         setTelemetry(bool on);
+    bool         getTelemetry() { return _telemetry.enabled(); }
     virtual void autoReport();
     void         autoReportGCodeState();
 
-    void push(uint8_t byte);
-    void push(uint8_t* data, size_t length) {
-        while (length--) {
-            push(*data++);
-        }
-    }
-    void push(std::string_view data) {
-        for (auto const& c : data) {
-            push((uint8_t)c);
-        }
-    }
+    // Queues the characters, except for realtime characters, which are handled at once
+    void push(const uint8_t* data, size_t length);
+    void push(uint8_t byte) { push(&byte, 1); }
+    void push(std::string_view data) { push((const uint8_t*)data.data(), data.length()); }
 
     void push(const std::string& s) { push((uint8_t*)s.c_str(), s.length()); }
 
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "CompiledGCode.h"
+
+#include <cstring>
+
+namespace CompiledGCode {
+    bool isCompiled(const char* header, size_t length) {
+        return length >= headerSize && !memcmp(header, magic, 4);
+    }
+
+    // The block that InputFile read for the line that is being executed.  The
+    // polling task sets it before it hands over the line, and the main task takes it
+    // before it asks for another.
+    static gc_word_t pendingWords[maxWords];
+    static size_t    pendingCount = 0;
+    static bool      pending      = false;
+
+    // Both the ESP32 and the hosts that compile jobs are little-endian, so a
+    // value is copied as it is.
+    size_t packWords(const gc_word_t* words, size_t count, uint8_t* out) {
+        for (size_t i = 0; i < count; ++i, out += wordSize) {
+            out[0] = uint8_t(words[i].letter);
+            memcpy(out + 1, &words[i].value, sizeof(float));
+        }
+        return count * wordSize;
+    }
+
+    bool unpackWords(const uint8_t* in, size_t length, gc_word_t* words, size_t& count) {
+        if (length % wordSize || length / wordSize > maxWords) {
+            return false;
+        }
+        count = length / wordSize;
+        for (size_t i = 0; i < count; ++i, in += wordSize) {
+            words[i].letter = char(in[0]);
+            memcpy(&words[i].value, in + 1, sizeof(float));
+        }
+        return true;
+    }
+
+    bool setBlock(const uint8_t* in, size_t length) {
+        pending = unpackWords(in, length, pendingWords, pendingCount);
+        return pending;
+    }
+
+    bool takeBlock(gc_word_t* words, size_t& count) {
+        if (!pending) {
+            return false;
+        }
+        pending = false;
+        count   = pendingCount;
+        memcpy(words, pendingWords, count * sizeof(gc_word_t));
+        return true;
+    }
+
+    void dropBlock() { pending = false; }
+
+    uint32_t getUint32(const uint8_t* in) {
+        return in[0] | (in[1] << 8) | (in[2] << 16) | (uint32_t(in[3]) << 24);
+    }
+
+    void putUint32(uint32_t value, uint8_t* out) {
+        out[0] = value;
+        out[1] = value >> 8;
+        out[2] = value >> 16;
+        out[3] = value >> 24;
+    }
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Compiled G-code jobs.  A compiled job is a G-code file whose blocks have been
+// split into words ahead of time, by collapseGCode() and gc_split_words() from
+// GCode.cpp, so running it skips the text handling and number parsing.  The
+// simulator writes them with --compile, from the same sources as the firmware.
+//
+// The file starts with the 4 byte magic "FNCG" and a version byte, followed by
+// one record per source line that does something:
+//
+//   line number   uint32, little-endian
+//   count         uint8
+//   payload       count words of 5 bytes: the letter, then the value as a
+//                 little-endian float.  If count is textRecord, the payload
+//                 is instead a length byte and that many characters of text.
+//
+// Lines that are not plain G-code - $ commands, lines with (MSG comments and
+// lines that have errors - are stored as text and run as text, so they behave
+// and report errors exactly as they would in a G-code file.  The modal state
+// is not stored; the decoding of the words depends on the machine config, so
+// it is still done by gc_execute_line().
+//
+// InputFile recognizes compiled files by the magic.  It decodes each block into
+// the pending block, and hands gc_execute_line() a line that holds only
+// blockMarker.  The words are never taken from the line text, and channels drop
+// blockMarker from their input, so no input line can pose as a block.
+
+#include "GCodeWord.h"  // gc_word_t
+
+#include <cstddef>
+#include <cstdint>
+
+namespace CompiledGCode {
+    const char    magic[]    = "FNCG";
+    const uint8_t version    = 1;
+    const size_t  headerSize = 5;   // The magic and the version
+    const size_t  recordSize = 5;   // The line number and the count
+    const size_t  wordSize   = 5;   // The letter and the value
+    const uint8_t textRecord = 0xff;
+
+    // The only character of the line that gc_execute_line() is given for a block
+    const char blockMarker = '\x01';
+
+    // The most words in a block
+    const size_t maxWords = 50;
+
+    // True if the file starts with the magic.  The version must then be checked.
+    bool isCompiled(const char* header, size_t length);
+
+    inline bool isBlock(const char* line) { return line[0] == blockMarker; }
+
+    // Writes count words to out as they are stored in a block record, and returns
+    // the number of bytes written
+    size_t packWords(const gc_word_t* words, size_t count, uint8_t* out);
+
+    // Decodes the length bytes at in, as written by packWords(), into words.  Returns
+    // false if they are not a whole number of words or are more than maxWords.
+    bool unpackWords(const uint8_t* in, size_t length, gc_word_t* words, size_t& count);
+
+    // Decodes the words of a block record into the pending block.  Returns false,
+    // leaving no pending block, if unpackWords() rejects them.
+    bool setBlock(const uint8_t* in, size_t length);
+
+    // Copies the pending block to words, at least maxWords long, and clears it.
+    // Returns false if there was no pending block.
+    bool takeBlock(gc_word_t* words, size_t& count);
+
+    void dropBlock();
+
+    uint32_t getUint32(const uint8_t* in);
+    void     putUint32(uint32_t value, uint8_t* out);
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Arena.h"
+
+#include <freertos/FreeRTOS.h>  // xPortGetFreeHeapSize()
+#include <esp_system.h>         // esp_get_minimum_free_heap_size()
+
+#include <cstdlib>
+#include <new>
+
+namespace Configuration {
+    Arena::Block* Arena::_blocks        = nullptr;
+    char*         Arena::_next          = nullptr;
+    char*         Arena::_end           = nullptr;
+    bool          Arena::_open          = false;
+    size_t        Arena::_bytes         = 0;
+    size_t        Arena::_objects       = 0;
+    size_t        Arena::_heapObjects   = 0;
+    uint32_t      Arena::_heapLowWater  = 0;
+    uint32_t      Arena::_minFreeAtOpen = 0;
+
+    static size_t round_up(size_t size) {
+        const size_t align = alignof(std::max_align_t);
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    char* Arena::data(Block* block) {
+        return reinterpret_cast<char*>(block) + round_up(sizeof(Block));
+    }
+
+    bool Arena::addBlock(size_t size) {
+        auto block = static_cast<Block*>(malloc(round_up(sizeof(Block)) + size));
+        if (!block) {
+            return false;
+        }
+        block->next = _blocks;
+        block->end  = data(block) + size;
+        _blocks     = block;
+        _next       = data(block);
+        _end        = block->end;
+        return true;
+    }
+
+    void Arena::freeBlocks() {
+        while (_blocks) {
+            Block* next = _blocks->next;
+            free(_blocks);
+            _blocks = next;
+        }
+    }
+
+    void Arena::sampleHeap() {
+        if (!_open) {
+            return;
+        }
+        uint32_t free = xPortGetFreeHeapSize();
+        if (free < _heapLowWater) {
+            _heapLowWater = free;
+        }
+    }
+
+    size_t Arena::sizeFor(std::string_view yaml) {
+        // Comment lines and blank lines do not create anything
+        size_t keys      = 0;
+        bool   lineStart = true;
+        for (char c : yaml) {
+            if (c == '\n') {
+                lineStart = true;
+            } else if (lineStart && c != ' ') {
+                if (c != '#' && c != '\r') {
+                    ++keys;
+                }
+                lineStart = false;
+            }
+        }
+        return baseBytes + keys * bytesPerKey;
+    }
+
+    void Arena::open(size_t sizeHint) {
+        freeBlocks();
+        _open          = true;
+        _bytes         = 0;
+        _objects       = 0;
+        _heapObjects   = 0;
+        _heapLowWater  = UINT32_MAX;
+        _minFreeAtOpen = esp_get_minimum_free_heap_size();
+        // Without a first block, every object starts an overflow block
+        if (!addBlock(round_up(sizeHint))) {
+            _next = _end = nullptr;
+        }
+        sampleHeap();
+    }
+
+    void Arena::close() {
+        sampleHeap();
+        // Samples can miss a short-lived peak, but the system keeps its own low-water mark
+        uint32_t minFree = esp_get_minimum_free_heap_size();
+        if (minFree < _minFreeAtOpen && minFree < _heapLowWater) {
+            _heapLowWater = minFree;
+        }
+        _open = false;
+        _next = _end = nullptr;
+    }
+
+    void* Arena::allocate(size_t size) {
+        if (!_open) {
+            return ::operator new(size);
+        }
+        size = round_up(size);
+        if (size_t(_end - _next) < size) {
+            // A large object goes to the heap rather than wasting the rest of a block
+            if (size > overflowSize / 4 || !addBlock(overflowSize)) {
+                ++_heapObjects;
+                void* p = ::operator new(size);
+                sampleHeap();
+                return p;
+            }
+        }
+        void* p = _next;
+        _next += size;
+        _bytes += size;
+        ++_objects;
+        sampleHeap();
+        return p;
+    }
+
+    void Arena::release(void* p) {
+        for (Block* block = _blocks; block; block = block->next) {
+            if (p >= data(block) && p < block->end) {
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+}
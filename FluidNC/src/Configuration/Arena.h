@@ -0,0 +1,78 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Configuration {
+    // Arena holds the Configurable objects that are created while the configuration
+    // is loaded.  Instead of a heap block for each section, they are packed one
+    // after another into one block that is sized from the YAML text, so the
+    // tree is a single run of memory without a heap header per object, and it
+    // does not leave holes among the strings and vectors that are freed after
+    // the load.  If the first block fills, the rest go into small overflow blocks.
+    //
+    // Configurables that are created when the arena is not open come from the
+    // heap as before.  Deleting an object in the arena runs its destructor but
+    // does not free its memory.  The blocks of a load are freed when the next
+    // load opens the arena, after ~MachineConfig has deleted the whole old tree,
+    // so the strings, vectors and pins that its sections own are freed too.
+    class Arena {
+        struct Block {
+            Block* next;
+            char*  end;
+        };
+
+        static Block*   _blocks;  // All blocks, the newest first
+        static char*    _next;    // Free space in the newest block
+        static char*    _end;
+        static bool     _open;
+        static size_t   _bytes;
+        static size_t   _objects;
+        static size_t   _heapObjects;
+        static uint32_t _heapLowWater;
+        static uint32_t _minFreeAtOpen;
+
+        static char* data(Block* block);
+        static bool  addBlock(size_t size);
+        static void  freeBlocks();
+
+    public:
+        static const size_t overflowSize = 1024;
+
+        // The defaults that afterParse() creates take about baseBytes, and each key
+        // line of the YAML adds about bytesPerKey.  These were measured in the
+        // simulator; as the sections are mostly pointers, strings and floats, they
+        // are scaled by the size of a pointer.
+        static const size_t baseBytes   = 184 * sizeof(void*);
+        static const size_t bytesPerKey = 3 * sizeof(void*) / 2;
+
+        // Returns the expected size of the Configurables for the YAML text
+        static size_t sizeFor(std::string_view yaml);
+
+        // Frees the blocks of the previous load and starts putting new Configurables
+        // in the arena, with a first block of about sizeHint bytes
+        static void open(size_t sizeHint);
+        static void close();
+
+        static void* allocate(size_t size);
+        static void  release(void* p);
+
+        // Statistics for the last load
+        static size_t bytes() { return _bytes; }
+        static size_t objects() { return _objects; }
+        static size_t heapObjects() { return _heapObjects; }  // That did not fit in a block
+
+        // Notes the free heap size for heapLowWater().  The arena samples it on each
+        // allocation, and the config handlers after each key, which catches the
+        // strings, vectors and pins that the sections allocate for their values.
+        static void sampleHeap();
+
+        // The lowest free heap size that was seen since open().  If the load set a
+        // new low for the heap, that is taken from the system, so it is exact.
+        static uint32_t heapLowWater() { return _heapLowWater; }
+    };
+}
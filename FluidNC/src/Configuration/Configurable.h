@@ -5,6 +5,7 @@
 
 #include "Generator.h"
 #include "Parser.h"
+#include "Arena.h"
 
 namespace Configuration {
     class HandlerBase;
@@ -25,5 +26,9 @@ namespace Configuration {
         // virtual const char* name() const = 0;
 
         virtual ~Configurable() {}
+
+        // Sections that are created while the configuration is loaded go in the Arena
+        static void* operator new(size_t size) { return Arena::allocate(size); }
+        static void  operator delete(void* p) { Arena::release(p); }
     };
 }
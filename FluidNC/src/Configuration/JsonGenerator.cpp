@@ -71,7 +71,7 @@ namespace Configuration {
     void JsonGenerator::item(const char* name, int& value, int32_t minValue, int32_t maxValue) {
         enter(name);
         char buf[32];
-        itoa(value, buf, 10);
+        snprintf(buf, sizeof(buf), "%d", value);
         _encoder.begin_webui(_currentPath, _currentPath, "I", buf, minValue, maxValue);
         _encoder.end_object();
         leave();
@@ -80,7 +80,7 @@ namespace Configuration {
     void JsonGenerator::item(const char* name, uint32_t& value, uint32_t minValue, uint32_t maxValue) {
         enter(name);
         char buf[32];
-        itoa(value, buf, 10);
+        snprintf(buf, sizeof(buf), "%u", value);
         _encoder.begin_webui(_currentPath, _currentPath, "I", buf, minValue, maxValue);
         _encoder.end_object();
         leave();
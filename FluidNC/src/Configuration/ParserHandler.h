@@ -6,6 +6,7 @@
 #include "HandlerBase.h"
 #include "Parser.h"
 #include "Configurable.h"
+#include "Arena.h"
 #include "../System.h"
 #include "parser_logging.h"
 
@@ -47,6 +48,7 @@ namespace Configuration {
                         log_parser_verbose("Parsing key " << _parser.key());
                         try {
                             section->group(*this);
+                            Arena::sampleHeap();
                         } catch (const AssertionFailed& ex) {
                             // Log something meaningful to the user:
                             log_error("Configuration error at "; for (auto it : _path) { ss << '/' << it; } ss << ": " << ex.msg);
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "PathIndex.h"
+
+#include "../string_util.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Configuration {
+    std::vector<PathIndex::Entry> PathIndex::_sections;
+    std::string                   PathIndex::_paths;
+    bool                          PathIndex::_built = false;
+
+    uint32_t PathIndex::extend(uint32_t hash, std::string_view s) {
+        for (char c : s) {
+            hash = (hash ^ uint8_t(string_util::tolower(c))) * 16777619u;
+        }
+        return hash;
+    }
+
+    void PathIndex::enterSection(const char* name, Configuration::Configurable* value) {
+        auto previousHash   = _pathHash;
+        auto previousLength = _path.length();
+        _pathHash           = extend(extend(_pathHash, "/"), name);
+        if (!_path.empty()) {
+            _path += '/';
+        }
+        _path += name;
+        if (_paths.length() + _path.length() > UINT16_MAX) {
+            throw std::length_error("Configuration paths are too long to index");
+        }
+        _sections.push_back({ _pathHash, uint16_t(_paths.length()), uint16_t(_path.length()), value });
+        _paths += _path;
+        value->group(*this);
+        _pathHash = previousHash;
+        _path.resize(previousLength);
+    }
+
+    void PathIndex::build(Configurable* root) {
+        clear();
+        _sections.push_back({ rootHash, 0, 0, root });
+        try {
+            PathIndex indexer;
+            root->group(indexer);
+        } catch (const std::length_error&) {
+            // Search the tree instead
+            clear();
+            return;
+        }
+
+        std::sort(_sections.begin(), _sections.end());
+        _sections.shrink_to_fit();
+        _paths.shrink_to_fit();
+        _built = true;
+    }
+
+    void PathIndex::clear() {
+        _sections.clear();
+        _sections.shrink_to_fit();
+        _paths.clear();
+        _paths.shrink_to_fit();
+        _built = false;
+    }
+
+    Configurable* PathIndex::find(std::string_view path) {
+        uint32_t hash = path.empty() ? rootHash : extend(extend(rootHash, "/"), path);
+        for (auto it = std::lower_bound(_sections.begin(), _sections.end(), Entry { hash, 0, 0, nullptr });
+             it != _sections.end() && it->hash == hash;
+             ++it) {
+            if (string_util::equal_ignore_case(std::string_view(_paths).substr(it->offset, it->length), path)) {
+                return it->section;
+            }
+        }
+        return nullptr;
+    }
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "HandlerBase.h"
+#include "Configurable.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Configuration {
+    // PathIndex records the path of every section in the configuration tree, so
+    // that a $/path setting can be handled by running the group() of the section
+    // that holds it instead of searching the tree.  It is built after the
+    // configuration is loaded; until then find() is not used and the tree is
+    // searched as before.
+    //
+    // A section is looked up by a hash of its path, in one small sorted array.
+    // The paths are kept in one string, so a hit is confirmed by comparing them
+    // and sections whose paths have the same hash are told apart.
+    class PathIndex : public Configuration::HandlerBase {
+    private:
+        struct Entry {
+            uint32_t      hash;
+            uint16_t      offset;  // Of the path in _paths
+            uint16_t      length;
+            Configurable* section;
+
+            bool operator<(const Entry& other) const { return hash < other.hash; }
+        };
+
+        static std::vector<Entry> _sections;  // Sorted by hash
+        static std::string        _paths;     // The paths of the sections, one after another
+        static bool               _built;
+
+        // The hash of a path is the case-insensitive FNV-1a hash of '/' and each
+        // of its names, so the root's is the FNV offset basis
+        static constexpr uint32_t rootHash = 2166136261u;
+
+        static uint32_t extend(uint32_t hash, std::string_view s);
+
+        uint32_t    _pathHash = rootHash;  // The hash of the path of the current section
+        std::string _path;                 // The path of the current section
+
+    protected:
+        void enterSection(const char* name, Configuration::Configurable* value) override;
+        bool matchesUninitialized(const char* name) override { return false; }
+
+    public:
+        // Indexes the tree under root, replacing any earlier index
+        static void build(Configurable* root);
+        static void clear();
+        static bool built() { return _built; }
+
+        // Returns the section at path, which has no leading or trailing '/', or
+        // nullptr if there is no such section.  The root is at the empty path.
+        static Configurable* find(std::string_view path);
+
+        void item(const char* name, bool& value) override {}
+        void item(const char* name, int32_t& value, int32_t minValue, int32_t maxValue) override {}
+        void item(const char* name, uint32_t& value, uint32_t minValue, uint32_t maxValue) override {}
+        void item(const char* name, float& value, float minValue, float maxValue) override {}
+        void item(const char* name, std::vector<speedEntry>& value) override {}
+        void item(const char* name, UartData& wordLength, UartParity& parity, UartStop& stopBits) override {}
+        void item(const char* name, std::string& value, int minLength, int maxLength) override {}
+        void item(const char* name, Pin& value) override {}
+        void item(const char* name, IPAddress& value) override {}
+        void item(const char* name, int& value, EnumItem* e) override {}
+
+        HandlerType handlerType() override { return HandlerType::Indexer; }
+    };
+}
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "RuntimeSetting.h"
+#include "PathIndex.h"
 
 #include "../Report.h"
 #include "../Protocol.h"  // send_line()
@@ -27,6 +28,21 @@ namespace Configuration {
         return s;
     }
 
+    void RuntimeSetting::handleIndexed() {
+        std::string_view path(setting_);
+        if (path.length() && path.back() == '/') {
+            path.remove_suffix(1);
+        }
+        // The last name in the path is a section or item of the section at the rest of the path
+        auto          slash   = path.rfind('/');
+        Configurable* section = PathIndex::find(slash == std::string_view::npos ? std::string_view() : path.substr(0, slash));
+        if (section) {
+            start_ = slash == std::string_view::npos ? setting_ : setting_ + slash + 1;
+            section->group(*this);
+            start_ = setting_;
+        }
+    }
+
     void RuntimeSetting::enterSection(const char* name, Configuration::Configurable* value) {
         if (is(name) && !isHandled_) {
             auto previous = start_;
@@ -46,6 +46,10 @@ namespace Configuration {
 
         std::string setting_prefix();
 
+        // Handles the setting in the section that PathIndex says holds it, instead
+        // of searching from the root.  Does nothing if it is not in the index.
+        void handleIndexed();
+
         HandlerType handlerType() override { return HandlerType::Runtime; }
 
         bool isHandled_ = false;
@@ -0,0 +1,278 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Snapshot.h"
+
+#include "HandlerBase.h"
+#include "Arena.h"
+#include "../Assert.h"
+#include "../Report.h"  // git_info
+
+#include <cstdint>
+#include <cstring>
+
+namespace Configuration {
+    static const char    magic[]       = "FNCS";
+    static const uint8_t formatVersion = 1;
+
+    class SnapshotWriter : public HandlerBase {
+        std::string& _out;
+
+        template <typename T>
+        void raw(const T& value) {
+            _out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void text(std::string_view s) {
+            raw(uint16_t(s.length()));
+            _out.append(s.data(), s.length());
+        }
+
+        void record(char type, const char* name) {
+            auto len = strlen(name);
+            Assert(len <= UINT8_MAX, "Name %s is too long for a snapshot", name);
+            _out += type;
+            _out += char(len);
+            _out.append(name, len);
+        }
+
+    public:
+        SnapshotWriter(std::string& out) : _out(out) {}
+
+        void enterSection(const char* name, Configurable* value) override {
+            record('{', name);
+            value->group(*this);
+            _out += '}';
+        }
+        bool matchesUninitialized(const char* name) override { return false; }
+
+        void item(const char* name, bool& value) override {
+            record('b', name);
+            raw(uint8_t(value));
+        }
+        void item(const char* name, int32_t& value, int32_t minValue, int32_t maxValue) override {
+            record('i', name);
+            raw(value);
+        }
+        void item(const char* name, uint32_t& value, uint32_t minValue, uint32_t maxValue) override {
+            record('u', name);
+            raw(value);
+        }
+        void item(const char* name, float& value, float minValue, float maxValue) override {
+            record('f', name);
+            raw(value);
+        }
+        void item(const char* name, std::vector<speedEntry>& value) override {
+            record('v', name);
+            raw(uint16_t(value.size()));
+            for (auto const& entry : value) {
+                raw(entry.speed);
+                raw(entry.percent);
+            }
+        }
+        void item(const char* name, UartData& wordLength, UartParity& parity, UartStop& stopBits) override {
+            record('m', name);
+            raw(wordLength);
+            raw(parity);
+            raw(stopBits);
+        }
+        void item(const char* name, std::string& value, int minLength, int maxLength) override {
+            record('s', name);
+            text(value);
+        }
+        void item(const char* name, Pin& value) override {
+            record('p', name);
+            text(value.name());
+        }
+        void item(const char* name, IPAddress& value) override {
+            record('a', name);
+            raw(uint32_t(value));
+        }
+        void item(const char* name, int& value, EnumItem* e) override {
+            record('e', name);
+            raw(value);
+        }
+
+        HandlerType handlerType() override { return HandlerType::Snapshot; }
+    };
+
+    // The reader is a Parser, so that section() and the factories create the
+    // sections that it finds
+    class SnapshotReader : public HandlerBase {
+        std::string_view _data;  // The records that have not been read
+
+        // Returns true if the next record is for name with the given type, and
+        // if consume is true, skips its type and name
+        bool next(char type, const char* name, bool consume = true) {
+            if (_data.length() < 2 || _data[0] != type) {
+                return false;
+            }
+            size_t len = uint8_t(_data[1]);
+            if (_data.length() < 2 + len || _data.substr(2, len) != name) {
+                return false;
+            }
+            if (consume) {
+                _data.remove_prefix(2 + len);
+            }
+            return true;
+        }
+
+        template <typename T>
+        T raw() {
+            T value;
+            Assert(_data.length() >= sizeof(value), "Snapshot is truncated");
+            memcpy(&value, _data.data(), sizeof(value));
+            _data.remove_prefix(sizeof(value));
+            return value;
+        }
+
+        std::string_view text() {
+            auto len = raw<uint16_t>();
+            Assert(_data.length() >= len, "Snapshot is truncated");
+            auto s = _data.substr(0, len);
+            _data.remove_prefix(len);
+            return s;
+        }
+
+    public:
+        SnapshotReader(std::string_view records) : _data(records) {}
+
+        bool done() { return _data.empty(); }
+
+        // A factory also enters a section that it made in an earlier pass, so a
+        // section with no record here is not an error
+        void enterSection(const char* name, Configurable* section) override {
+            if (!next('{', name)) {
+                return;
+            }
+            while (_data.length() && _data[0] != '}') {
+                auto remaining = _data.length();
+                section->group(*this);
+                Arena::sampleHeap();
+                Assert(_data.length() < remaining, "Snapshot does not fit section %s", name);
+            }
+            Assert(_data.length(), "Snapshot is truncated");
+            _data.remove_prefix(1);
+        }
+        bool matchesUninitialized(const char* name) override { return next('{', name, false); }
+
+        void item(const char* name, bool& value) override {
+            if (next('b', name)) {
+                value = raw<uint8_t>();
+            }
+        }
+        void item(const char* name, int32_t& value, int32_t minValue, int32_t maxValue) override {
+            if (next('i', name)) {
+                value = raw<int32_t>();
+            }
+        }
+        void item(const char* name, uint32_t& value, uint32_t minValue, uint32_t maxValue) override {
+            if (next('u', name)) {
+                value = raw<uint32_t>();
+            }
+        }
+        void item(const char* name, float& value, float minValue, float maxValue) override {
+            if (next('f', name)) {
+                value = raw<float>();
+            }
+        }
+        void item(const char* name, std::vector<speedEntry>& value) override {
+            if (next('v', name)) {
+                value.clear();
+                for (auto n = raw<uint16_t>(); n; --n) {
+                    speedEntry entry;
+                    entry.speed   = raw<SpindleSpeed>();
+                    entry.percent = raw<float>();
+                    value.push_back(entry);
+                }
+            }
+        }
+        void item(const char* name, UartData& wordLength, UartParity& parity, UartStop& stopBits) override {
+            if (next('m', name)) {
+                wordLength = raw<UartData>();
+                parity     = raw<UartParity>();
+                stopBits   = raw<UartStop>();
+            }
+        }
+        void item(const char* name, std::string& value, int minLength, int maxLength) override {
+            if (next('s', name)) {
+                value = text();
+            }
+        }
+        void item(const char* name, Pin& value) override {
+            if (next('p', name)) {
+                auto pin = Pin::create(text());
+                value.swap(pin);
+            }
+        }
+        void item(const char* name, IPAddress& value) override {
+            if (next('a', name)) {
+                value = IPAddress(raw<uint32_t>());
+            }
+        }
+        void item(const char* name, int& value, EnumItem* e) override {
+            if (next('e', name)) {
+                value = raw<int>();
+            }
+        }
+
+        HandlerType handlerType() override { return HandlerType::Parser; }
+    };
+
+    // The header is the magic, the format version, the firmware version, the
+    // YAML hash and the size of the sections
+    std::string Snapshot::write(Configurable* root, const std::string& yamlHash, size_t arenaBytes) {
+        std::string out(magic);
+        out += char(formatVersion);
+        out += char(strlen(git_info));
+        out += git_info;
+        out += char(yamlHash.length());
+        out += yamlHash;
+        uint32_t bytes = arenaBytes;
+        out.append(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+
+        SnapshotWriter writer(out);
+        writer.enterSection("machine", root);
+        return out;
+    }
+
+    bool Snapshot::matches(std::string_view& snapshot, const std::string& yamlHash, size_t& arenaBytes) {
+        std::string_view data(snapshot);
+        auto             field = [&data](std::string_view expected) {
+            if (data.empty() || uint8_t(data[0]) != expected.length() || data.substr(1, expected.length()) != expected) {
+                return false;
+            }
+            data.remove_prefix(1 + expected.length());
+            return true;
+        };
+        if (data.substr(0, strlen(magic)) != magic) {
+            return false;
+        }
+        data.remove_prefix(strlen(magic));
+        if (data.empty() || uint8_t(data[0]) != formatVersion) {
+            return false;
+        }
+        data.remove_prefix(1);
+        if (!field(git_info) || !field(yamlHash) || data.length() < sizeof(uint32_t)) {
+            return false;
+        }
+        uint32_t bytes;
+        memcpy(&bytes, data.data(), sizeof(bytes));
+        data.remove_prefix(sizeof(bytes));
+
+        arenaBytes = bytes;
+        snapshot   = data;
+        return true;
+    }
+
+    bool Snapshot::read(std::string_view records, Configurable* root) {
+        try {
+            SnapshotReader reader(records);
+            reader.enterSection("machine", root);
+            return reader.done();
+        } catch (const AssertionFailed& ex) {
+            log_info(ex.what());
+            return false;
+        } catch (...) { return false; }
+    }
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// A Snapshot is a validated configuration tree in a compact binary form, so that
+// the tree can be built again without parsing the YAML that it came from.  It
+// is a header followed by one record for each section and item, in the order
+// that group() visits them:
+//
+//   '{' name  ...  '}'      A section and the records inside it
+//   type name value         An item; the type is a character for its C++ type
+//
+// A name is a length byte and its characters.  Values are stored as they are
+// in memory, except that pins and strings are a 16-bit length and their text.
+//
+// Reading a snapshot is like parsing: the records are handed to group() in
+// passes over each section, so a section that group() creates from a factory
+// or a list still finds its records.  If a pass takes no record, the snapshot
+// does not fit the tree, so read() fails and the YAML must be parsed instead.
+
+#include "Configurable.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Configuration {
+    class Snapshot {
+    public:
+        // Returns the snapshot of the tree under root.  yamlHash is the HashFS hash of
+        // the YAML that it was loaded from, and arenaBytes is the size of its sections.
+        static std::string write(Configurable* root, const std::string& yamlHash, size_t arenaBytes);
+
+        // Returns true if snapshot was written by this firmware from YAML with
+        // yamlHash.  If so, sets arenaBytes, and removes the header from snapshot.
+        static bool matches(std::string_view& snapshot, const std::string& yamlHash, size_t& arenaBytes);
+
+        // Builds the tree under root from the records of a snapshot.  Returns false
+        // if they do not fit the tree, which may then be partly built.
+        static bool read(std::string_view records, Configurable* root);
+    };
+}
@@ -6,6 +6,7 @@
 // RS274/NGC parser.
 
 #include "GCode.h"
+#include "CompiledGCode.h"
 #include "Settings.h"
 #include "Config.h"
 #include "Report.h"
@@ -135,15 +136,64 @@ static void gc_wco_changed() {
     allChannels.notifyWco();
 }
 
+// Splits a line that has been through collapseGCode() into words, each
+// a letter followed by a number.  The words are not checked further here.
+Error gc_split_words(const char* line, gc_word_t* words, size_t max_words, size_t& n_words) {
+    size_t char_counter = 0;
+    n_words             = 0;
+    while (line[char_counter] != 0) {  // Loop until no more g-code words in line.
+        // Import the next g-code word, expecting a letter followed by a value. Otherwise, error out.
+        char letter = line[char_counter];
+        if ((letter < 'A') || (letter > 'Z')) {
+            FAIL(Error::ExpectedCommandLetter);  // [Expected word letter]
+        }
+        char_counter++;
+        float value;
+        if (!read_float(line, &char_counter, &value)) {
+            FAIL(Error::BadNumberFormat);  // [Expected word value]
+        }
+        if (n_words == max_words) {
+            FAIL(Error::LineLengthExceeded);
+        }
+        words[n_words++] = { letter, value };
+    }
+    return Error::Ok;
+}
+
 // Executes one line of NUL-terminated G-Code.
 // The line may contain whitespace and comments, which are first removed,
 // and lower case characters, which are converted to upper case.
+// The line can instead hold a block from a compiled job, whose words were
+// split ahead of time (see CompiledGCode.h).
 // In this function, all units and positions are converted and
 // exported to internal functions in terms of (mm, mm/min) and absolute machine
 // coordinates, respectively.
 Error gc_execute_line(char* line) {
-    // Step 0 - remove whitespace and comments and convert to upper case
-    collapseGCode(line);
+    // A text line has at most one word for every two characters
+    static gc_word_t words[Channel::maxLine / 2 + 1];
+    size_t           n_words;
+    bool             jogMotion = false;
+
+    static_assert(CompiledGCode::maxWords <= sizeof(words) / sizeof(words[0]), "A compiled block must fit in words");
+
+    if (CompiledGCode::isBlock(line)) {
+        // The words were read by InputFile; the line only says that they are there
+        if (!CompiledGCode::takeBlock(words, n_words)) {
+            FAIL(Error::InvalidStatement);
+        }
+    } else {
+        // Step 0 - remove whitespace and comments and convert to upper case
+        collapseGCode(line);
+
+        // Determine if the line is a jogging motion or a normal g-code block.
+        // NOTE: `$J=` already parsed when passed to this function.
+        jogMotion = line[0] == '$';
+
+        Error status = gc_split_words(jogMotion ? line + 3 : line, words, sizeof(words) / sizeof(words[0]), n_words);
+        if (status != Error::Ok) {
+            FAIL(status);
+        }
+    }
 
     /* -------------------------------------------------------------------------------------
        STEP 1: Initialize parser block struct and copy current g-code state modes. The parser
@@ -163,7 +213,6 @@ Error gc_execute_line(char* line) {
     uint32_t command_words = 0;  // Tracks G and M command words. Also used for modal group violations.
     uint32_t value_words   = 0;  // Tracks value words.
 
-    bool jogMotion     = false;
     bool checkMantissa = false;
     bool clockwiseArc  = false;
     bool probeExplicit = false;
@@ -178,10 +227,8 @@ Error gc_execute_line(char* line) {
     float   coord_data[MAX_N_AXIS];  // Used by WCO-related commands
     uint8_t pValue;                  // Integer value of P word
 
-    // Determine if the line is a jogging motion or a normal g-code block.
-    if (line[0] == '$') {  // NOTE: `$J=` already parsed when passed to this function.
+    if (jogMotion) {
         // Set G1 and G94 enforced modes to ensure accurate error checks.
-        jogMotion                = true;
         gc_block.modal.motion    = Motion::Linear;
         gc_block.modal.feed_rate = FeedRate::UnitsPerMin;
         if (config->_useLineNumbers) {
@@ -196,22 +243,13 @@ Error gc_execute_line(char* line) {
        words, and for negative values set for the value words F, N, P, T, and S. */
     ModalGroup mg_word_bit;  // Bit-value for assigning tracking variables
     uint32_t   bitmask = 0;
-    size_t     char_counter;
     char       letter;
     float      value;
     uint8_t    int_value = 0;
     uint16_t   mantissa  = 0;
-    char_counter         = jogMotion ? 3 : 0;  // Start parsing after `$J=` if jogging
-    while (line[char_counter] != 0) {          // Loop until no more g-code words in line.
-        // Import the next g-code word, expecting a letter followed by a value. Otherwise, error out.
-        letter = line[char_counter];
-        if ((letter < 'A') || (letter > 'Z')) {
-            FAIL(Error::ExpectedCommandLetter);  // [Expected word letter]
-        }
-        char_counter++;
-        if (!read_float(line, &char_counter, &value)) {
-            FAIL(Error::BadNumberFormat);  // [Expected word value]
-        }
+    for (size_t word = 0; word < n_words; ++word) {
+        letter = words[word].letter;
+        value  = words[word].value;
         // Convert values to smaller uint8 significand and mantissa values for parsing this word.
         // NOTE: Mantissa is multiplied by 100 to catch non-integer command values. This is more
         // accurate than the NIST gcode requirement of x10 when used for commands, but not quite
@@ -466,8 +504,12 @@ Error gc_execute_line(char* line) {
                         if (mantissa != 0) {
                             FAIL(Error::GcodeUnsupportedCommand);  // [G61.1 not supported]
                         }
-                        // gc_block.modal.control = ControlMode::ExactPath; // G61
-                        mg_word_bit = ModalGroup::MG13;
+                        gc_block.modal.control = ControlMode::ExactPath;  // G61
+                        mg_word_bit            = ModalGroup::MG13;
+                        break;
+                    case 64:
+                        gc_block.modal.control = ControlMode::Continuous;  // G64
+                        mg_word_bit            = ModalGroup::MG13;
                         break;
                     default:
                         FAIL(Error::GcodeUnsupportedCommand);  // [Unsupported G command]
@@ -942,7 +984,22 @@ Error gc_execute_line(char* line) {
             coords[gc_block.modal.coord_select]->get(block_coord_system);
         }
     }
-    // [16. Set path control mode ]: N/A. Only G61. G61.1 and G64 NOT SUPPORTED.
+    // [16. Set path control mode ]: G61.1 NOT SUPPORTED. The optional G64 P word is the path tolerance.
+    float path_tolerance = gc_state.path_tolerance;
+    if (bitnum_is_true(command_words, ModalGroup::MG13) && gc_block.modal.control == ControlMode::Continuous) {
+        if (bitnum_is_true(value_words, GCodeWord::P)) {
+            if (gc_block.values.p < 0.0) {
+                FAIL(Error::NegativeValue);  // [Path tolerance cannot be negative]
+            }
+            path_tolerance = gc_block.values.p;
+            if (gc_block.modal.units == Units::Inches) {
+                path_tolerance *= MM_PER_INCH;
+            }
+            clear_bitnum(value_words, GCodeWord::P);
+        } else {
+            path_tolerance = config->_junctionDeviation;
+        }
+    }
     // [17. Set distance mode ]: N/A. Only G91.1. G90.1 NOT SUPPORTED.
     // [18. Set retract mode ]: NOT SUPPORTED.
     // [19. Remaining non-modal actions ]: Check go to predefined position, set G10, or set axis offsets.
@@ -1539,8 +1596,12 @@ Error gc_execute_line(char* line) {
         copyAxes(gc_state.coord_system, block_coord_system);
         gc_wco_changed();
     }
-    // [16. Set path control mode ]: G61.1/G64 NOT SUPPORTED
-    // gc_state.modal.control = gc_block.modal.control; // NOTE: Always default.
+    // [16. Set path control mode ]: G61.1 NOT SUPPORTED
+    gc_state.modal.control  = gc_block.modal.control;
+    gc_state.path_tolerance = path_tolerance;
+    if (gc_state.modal.control == ControlMode::Continuous) {
+        pl_data->path_tolerance = gc_state.path_tolerance;  // Record data for planner use.
+    }
     // [17. Set distance mode ]:
     gc_state.modal.distance = gc_block.modal.distance;
     // [18. Set retract mode ]: NOT SUPPORTED
@@ -1662,6 +1723,7 @@ Error gc_execute_line(char* line) {
             gc_state.modal.feed_rate    = FeedRate::UnitsPerMin;
             // gc_state.modal.cutter_comp = CutterComp::Disable; // Not supported.
             gc_state.modal.coord_select = CoordIndex::G54;
+            gc_state.modal.control      = ControlMode::ExactPath;
             gc_state.modal.spindle      = SpindleState::Disable;
             gc_state.modal.coolant      = {};
             if (config->_enableParkingOverrideControl) {
@@ -1719,7 +1781,7 @@ Error gc_execute_line(char* line) {
    group 8 = {M7*} enable mist coolant (* Compile-option)
    group 9 = {M48, M49} enable/disable feed and speed override switches
    group 10 = {G98, G99} return mode canned cycles
-   group 13 = {G61.1, G64} path control mode (G61 is supported)
+   group 13 = {G61.1} path control mode (G61 and G64 are supported)
 */
 
 void WEAK_LINK user_m30() {}
@@ -7,6 +7,7 @@
 
 #include "Config.h"
 #include "Error.h"
+#include "GCodeWord.h"
 #include "SpindleDatatypes.h"
 
 #include <cstdint>
@@ -126,7 +127,8 @@ enum class CutterCompensation : uint8_t {
 
 // Modal Group G13: Control mode
 enum class ControlMode : uint8_t {
-    ExactPath = 0,  // G61 (Default: Must be zero)
+    ExactPath  = 0,  // G61 (Default: Must be zero)
+    Continuous = 1,  // G64
 };
 
 // GCodeCoolant is used by the parser, where at most one of
@@ -244,13 +246,13 @@ struct gc_modal_t {
     // CutterCompensation cutter_comp;  // {G40} NOTE: Don't track. Only default supported.
     ToolLengthOffset tool_length;   // {G43.1,G49}
     CoordIndex       coord_select;  // {G54,G55,G56,G57,G58,G59}
-    // uint8_t control;      // {G61} NOTE: Don't track. Only default supported.
-    ProgramFlow  program_flow;  // {M0,M1,M2,M30}
-    CoolantState coolant;       // {M7,M8,M9}
-    SpindleState spindle;       // {M3,M4,M5}
-    ToolChange   tool_change;   // {M6}
-    IoControl    io_control;    // {M62, M63, M67}
-    Override     override;      // {M56}
+    ControlMode      control;       // {G61,G64}
+    ProgramFlow      program_flow;  // {M0,M1,M2,M30}
+    CoolantState     coolant;       // {M7,M8,M9}
+    SpindleState     spindle;       // {M3,M4,M5}
+    ToolChange       tool_change;   // {M6}
+    IoControl        io_control;    // {M62, M63, M67}
+    Override         override;      // {M56}
 };
 
 struct gc_values_t {
@@ -270,10 +272,11 @@ struct gc_values_t {
 struct parser_state_t {
     gc_modal_t modal;
 
-    float    spindle_speed;  // RPM
-    float    feed_rate;      // Millimeters/min
-    uint32_t tool;           // Tracks tool number. NOT USED.
-    int32_t  line_number;    // Last line number sent
+    float    spindle_speed;   // RPM
+    float    feed_rate;       // Millimeters/min
+    uint32_t tool;            // Tracks tool number. NOT USED.
+    int32_t  line_number;     // Last line number sent
+    float    path_tolerance;  // G64 P value in mm. How far corners may be rounded in continuous mode.
 
     float position[MAX_N_AXIS];  // Where the interpreter considers the tool to be at this point in the code
 
@@ -303,6 +306,13 @@ enum class AxisCommand : uint8_t {
 // Initialize the parser
 void gc_init();
 
+// Edit GCode line in-place, removing whitespace and comments and
+// converting to uppercase
+void collapseGCode(char* line);
+
+// Split a collapsed line into words
+Error gc_split_words(const char* line, gc_word_t* words, size_t max_words, size_t& n_words);
+
 // Execute one block of rs275/ngc/g-code
 Error gc_execute_line(char* line);
 
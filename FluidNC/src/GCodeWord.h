@@ -0,0 +1,10 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// A word of a block: a letter and the number that follows it
+struct gc_word_t {
+    char  letter;
+    float value;
+};
@@ -1,46 +1,187 @@
 #include "HashFS.h"
 #include "FileStream.h"
 
-#include <mbedtls/md.h>
+#include <cinttypes>
+#include <cstdio>
 
 std::map<std::string, std::string> HashFS::localFsHashes;
 
+const char* const HashFS::indexName = ".hashes";
+
+// The size, modification time and a sample of the contents of each hashed file, as they were when
+// it was hashed.  Without a set clock, the modification times of files that were written after
+// different startups can be the same, so the sample - a hash of the first and last sampleSize bytes -
+// catches a file that was rewritten with the same size and time.
+struct FileStamp {
+    uintmax_t size;
+    int64_t   mtime;
+    uint32_t  sample;
+
+    bool operator==(const FileStamp& o) const { return size == o.size && mtime == o.mtime && sample == o.sample; }
+};
+static std::map<std::string, FileStamp> stamps;
+
+static const size_t sampleSize = 512;
+
+static bool sampleFile(const std::filesystem::path& path, uintmax_t size, uint32_t& sample) {
+    FILE* fd = fopen(path.c_str(), "rb");
+    if (!fd) {
+        return false;
+    }
+    uint8_t buf[sampleSize];
+    sample = 2166136261u;  // FNV-1a
+    for (int block = 0; block < 2; ++block) {
+        size_t len = size < sampleSize ? size : sampleSize;
+        if (block && fseek(fd, long(size - len), SEEK_SET)) {
+            fclose(fd);
+            return false;
+        }
+        if (fread(buf, 1, len, fd) != len) {
+            fclose(fd);
+            return false;
+        }
+        for (size_t i = 0; i < len; ++i) {
+            sample = (sample ^ buf[i]) * 16777619u;
+        }
+    }
+    fclose(fd);
+    return true;
+}
+
+static bool getStamp(const std::filesystem::path& path, FileStamp& stamp) {
+    std::error_code ec;
+    stamp.size = stdfs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    stamp.mtime = stdfs::last_write_time(path, ec).time_since_epoch().count();
+    return !ec && sampleFile(path, stamp.size, stamp.sample);
+}
+
 static char hexNibble(int i) {
     return "0123456789ABCDEF"[i & 0xf];
 }
 
-static Error hashFile(const std::filesystem::path& ipath, std::string& str) {  // No ESP command
-    mbedtls_md_context_t ctx;
+HashFS::Hasher::Hasher() {
+    mbedtls_md_init(&_ctx);
+    mbedtls_md_setup(&_ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    mbedtls_md_starts(&_ctx);
+}
+
+HashFS::Hasher::~Hasher() {
+    mbedtls_md_free(&_ctx);
+}
+
+void HashFS::Hasher::update(const uint8_t* data, size_t length) {
+    mbedtls_md_update(&_ctx, data, length);
+}
 
+std::string HashFS::Hasher::finish() {
     uint8_t shaResult[32];
+    mbedtls_md_finish(&_ctx, shaResult);
 
+    std::string str;
+    str = '"';
+    for (int i = 0; i < 32; i++) {
+        uint8_t b = shaResult[i];
+        str += hexNibble(b >> 4);
+        str += hexNibble(b);
+    }
+    str += '"';
+    return str;
+}
+
+static Error hashFile(const std::filesystem::path& ipath, std::string& str) {  // No ESP command
     try {
-        FileStream inFile { ipath, "r" };
-        uint8_t    buf[512];
-        size_t     len;
+        FileStream     inFile { ipath, "r" };
+        HashFS::Hasher hasher;
+        uint8_t        buf[512];
+        size_t         len;
 
-        mbedtls_md_init(&ctx);
-        mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
-        mbedtls_md_starts(&ctx);
         while ((len = inFile.read(buf, 512)) > 0) {
-            mbedtls_md_update(&ctx, buf, len);
+            hasher.update(buf, len);
         }
-        mbedtls_md_finish(&ctx, shaResult);
-        mbedtls_md_free(&ctx);
+        str = hasher.finish();
     } catch (const Error err) {
         log_debug("Cannot hash file " << ipath);
         return Error::FsFailedOpenFile;
     }
+    return Error::Ok;
+}
 
-    str = '"';
-    for (int i = 0; i < 32; i++) {
-        uint8_t b = shaResult[i];
-        str += hexNibble(b >> 4);
-        str += hexNibble(b);
+// Each line of the index is: size mtime sample "hash" name
+void HashFS::save_index() {
+    std::error_code ec;
+    FluidPath       indexPath { indexName, localfsName, ec };
+    if (ec) {
+        return;
     }
-    str += '"';
+    try {
+        FileStream outFile { indexPath, "w" };
+        for (auto const& [name, hash] : localFsHashes) {
+            auto it = stamps.find(name);
+            if (it == stamps.end()) {
+                continue;  // Hashed again at the next startup
+            }
+            char prefix[56];
+            snprintf(prefix,
+                     sizeof(prefix),
+                     "%" PRIuMAX " %" PRId64 " %08" PRIx32 " ",
+                     it->second.size,
+                     it->second.mtime,
+                     it->second.sample);
+            std::string line(prefix);
+            line += hash;
+            line += ' ';
+            line += name;
+            line += '\n';
+            outFile.write(reinterpret_cast<const uint8_t*>(line.c_str()), line.length());
+        }
+    } catch (const Error err) {
+        log_debug("Cannot write " << indexPath);
+    }
+}
 
-    return Error::Ok;
+// Reads the saved hashes and the stamps that they go with
+static void loadIndex(std::map<std::string, std::pair<FileStamp, std::string>>& entries) {
+    std::error_code ec;
+    FluidPath       indexPath { HashFS::indexName, localfsName, ec };
+    if (ec) {
+        return;
+    }
+    std::string text;
+    try {
+        FileStream inFile { indexPath, "r" };
+        char       buf[512];
+        size_t     len;
+        while ((len = inFile.read(buf, sizeof(buf))) > 0) {
+            text.append(buf, len);
+        }
+    } catch (const Error err) {
+        return;  // No index yet
+    }
+
+    size_t pos = 0;
+    while (pos < text.length()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) {
+            end = text.length();
+        }
+        std::string line = text.substr(pos, end - pos);
+        pos              = end + 1;
+
+        FileStamp stamp;
+        int       hashStart = 0;
+        if (sscanf(line.c_str(), "%" SCNuMAX " %" SCNd64 " %" SCNx32 " %n", &stamp.size, &stamp.mtime, &stamp.sample, &hashStart) != 3 ||
+            !hashStart) {
+            continue;  // Not in this format, so the file is hashed again
+        }
+        size_t hashEnd = line.find('"', hashStart + 1);
+        if (line[hashStart] != '"' || hashEnd == std::string::npos || hashEnd + 2 > line.length()) {
+            continue;
+        }
+        entries[line.substr(hashEnd + 2)] = { stamp, line.substr(hashStart, hashEnd + 1 - hashStart) };
+    }
 }
 
 void HashFS::report_change() {
@@ -48,7 +189,10 @@ void HashFS::report_change() {
 }
 
 void HashFS::delete_file(const std::filesystem::path& path, bool report) {
-    localFsHashes.erase(path.filename());
+    if (localFsHashes.erase(path.filename())) {
+        stamps.erase(path.filename());
+        save_index();
+    }
     if (report) {
         report_change();
     }
@@ -65,17 +209,32 @@ bool HashFS::file_is_hashed(const std::filesystem::path& path) {
     if (count != 3) {
         return false;
     }
+    if (path.filename() == indexName) {
+        return false;
+    }
     auto fsname = *++path.begin();
     return fsname == "littlefs" || fsname == "spiffs" || fsname == "localfs";
 }
 
+void HashFS::set_hash(const std::filesystem::path& path, const std::string& hash, bool report) {
+    FileStamp stamp;
+    if (file_is_hashed(path) && getStamp(path, stamp)) {
+        localFsHashes[path.filename()] = hash;
+        stamps[path.filename()]        = stamp;
+        save_index();
+    }
+    if (report) {
+        report_change();
+    }
+}
+
 void HashFS::rehash_file(const std::filesystem::path& path, bool report) {
     if (file_is_hashed(path)) {
         std::string hash;
         if (hashFile(path, hash) != Error::Ok) {
             delete_file(path, false);
         } else {
-            localFsHashes[path.filename()] = hash;
+            set_hash(path, hash, false);
         }
     }
     if (report) {
@@ -83,12 +242,22 @@ void HashFS::rehash_file(const std::filesystem::path& path, bool report) {
     }
 }
 void HashFS::rename_file(const std::filesystem::path& ipath, const std::filesystem::path& opath, bool report) {
+    // The contents are the same, so the hash can move with the file
+    auto it = localFsHashes.find(ipath.filename());
+    if (file_is_hashed(ipath) && it != localFsHashes.end() && file_is_hashed(opath)) {
+        std::string hash = it->second;
+        localFsHashes.erase(it);
+        stamps.erase(ipath.filename());
+        set_hash(opath, hash, report);
+        return;
+    }
     delete_file(ipath, false);
     rehash_file(opath, report);
 }
 
 void HashFS::hash_all() {
     localFsHashes.clear();
+    stamps.clear();
 
     std::error_code ec;
     FluidPath       lfspath { "", localfsName, ec };
@@ -101,11 +270,38 @@ void HashFS::hash_all() {
         log_error(lfspath << " " << ec.message());
         return;
     }
+
+    std::map<std::string, std::pair<FileStamp, std::string>> saved;
+    loadIndex(saved);
+
+    size_t files  = 0;
+    size_t hashed = 0;
     for (auto const& dir_entry : iter) {
-        if (!dir_entry.is_directory()) {
-            rehash_file(dir_entry, false);
+        if (dir_entry.is_directory() || !file_is_hashed(dir_entry)) {
+            continue;
+        }
+        ++files;
+        std::string name = dir_entry.path().filename();
+        FileStamp   stamp;
+        auto        it = saved.find(name);
+        if (it != saved.end() && getStamp(dir_entry, stamp) && it->second.first == stamp) {
+            localFsHashes[name] = it->second.second;
+            stamps[name]        = stamp;
+            saved.erase(it);
+            continue;
         }
+        std::string hash;
+        if (hashFile(dir_entry, hash) == Error::Ok && getStamp(dir_entry, stamp)) {
+            localFsHashes[name] = hash;
+            stamps[name]        = stamp;
+        }
+        ++hashed;
+    }
+    // Rewrite the index if a file was hashed or one in the index is gone
+    if (hashed || !saved.empty()) {
+        save_index();
     }
+    log_debug("Hashed " << hashed << " of " << files << " files");
 }
 std::string HashFS::hash(const std::filesystem::path& path) {
     if (file_is_hashed(path)) {
@@ -3,6 +3,8 @@
 #include <map>
 #include <filesystem>
 
+#include <mbedtls/md.h>
+
 class HashFS {
 public:
     static std::map<std::string, std::string> localFsHashes;
@@ -14,7 +16,28 @@ public:
     static void hash_all();
     static void report_change();
 
+    // Records a hash that was computed with a Hasher as the file was written, instead of reading it back
+    static void set_hash(const std::filesystem::path& path, const std::string& hash, bool report = true);
+
     static std::string hash(const std::filesystem::path& path);
 
+    // Computes a hash in the same form as rehash_file(), from data that arrives a piece at a time
+    class Hasher {
+        mbedtls_md_context_t _ctx;
+
+    public:
+        Hasher();
+        ~Hasher();
+
+        void        update(const uint8_t* data, size_t length);
+        std::string finish();
+    };
+
+    // The hashes are saved in this file in the root of the local filesystem, with the size,
+    // modification time and a sample of the contents of each file, so that hash_all() only has
+    // to hash the files that changed.
+    static const char* const indexName;
+
 private:
+    static void save_index();
 };
@@ -4,38 +4,245 @@
 #include "InputFile.h"
 
 #include "Report.h"
+#include "CompiledGCode.h"
+#include "System.h"  // sys.abort
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <cstring>
+
+// The reader task fills the read-ahead blocks of all InputFiles, in the order
+// they are requested, so the blocks of a file are read in sequence.  It runs
+// on the support core, so a slow SD card read does not hold up the poller.
+struct ReadRequest {
+    InputFile* file;
+    int        block;
+};
+
+static QueueHandle_t readQueue  = nullptr;
+static TaskHandle_t  readerTask = nullptr;
+
+// How long to wait for the reader task at a time, between checks for a reset
+static const TickType_t readerWait = 10;
+
+static void reader_loop(void* unused) {
+    ReadRequest request;
+    while (true) {
+        if (xQueueReceive(readQueue, &request, portMAX_DELAY)) {
+            request.file->fill(request.block);
+        }
+    }
+}
+
+InputFile::InputFile(const char* defaultFs, const char* path, WebUI::AuthenticationLevel auth_level, Channel& out, bool readAhead) :
+    FileStream(path, "r", defaultFs), _auth_level(auth_level), _out(out), _line_num(0), _readAhead(readAhead),
+    _blockSize(readAhead ? readAheadBlockSize : directBlockSize) {
+    if (_readAhead && !readerTask) {
+        readQueue = xQueueCreate(4, sizeof(ReadRequest));
+        xTaskCreatePinnedToCore(reader_loop,       // task
+                                "reader",          // name for task
+                                4096,              // size of task stack
+                                0,                 // parameters
+                                2,                 // priority
+                                &readerTask,       // task handle
+                                SUPPORT_TASK_CORE  // core
+        );
+    }
+    for (int block = 0; block < 2; ++block) {
+        _blocks[block] = new char[_blockSize];
+        requestBlock(block);
+    }
+}
+
+void InputFile::requestBlock(int block) {
+    if (!_readAhead) {
+        fill(block);
+        return;
+    }
+    _lengths[block].store(pending, std::memory_order_relaxed);
+    ReadRequest request = { this, block };
+    while (xQueueSend(readQueue, &request, readerWait) != pdTRUE) {
+        if (sys.abort) {
+            // The block is never read, so it ends the file
+            _aborted = true;
+            _lengths[block].store(0, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+void InputFile::fill(int block) {
+    // A short read means end of file, or an error, which also ends the file
+    _lengths[block].store(int32_t(read(_blocks[block], _blockSize)), std::memory_order_release);
+}
+
+// Waits until the reader task is done with a block, even after a reset, as it
+// is writing into the block
+void InputFile::waitBlock(int block) {
+    while (_lengths[block].load(std::memory_order_acquire) == pending) {
+        vTaskDelay(1);
+    }
+}
+
+// Points data at the unread bytes of the current block, going on to the next
+// block when it is used up.  Returns the number of bytes, 0 at end of file or
+// if a reset stops the wait for the block.
+size_t InputFile::nextData(const char*& data) {
+    while (true) {
+        for (TickType_t waited = 0; _lengths[_current].load(std::memory_order_acquire) == pending; ++waited) {
+            if (waited >= readerWait && sys.abort) {
+                _aborted = true;
+                return 0;
+            }
+            vTaskDelay(1);
+        }
+        size_t length = _lengths[_current].load(std::memory_order_relaxed);
+        if (_offset < length) {
+            data = _blocks[_current] + _offset;
+            return length - _offset;
+        }
+        if (length < _blockSize) {
+            return 0;  // End of file
+        }
+        // The block is used up, so refill it and go on to the other one
+        requestBlock(_current);
+        _current ^= 1;
+        _offset = 0;
+    }
+}
+
+void InputFile::advance(size_t length) {
+    _offset += length;
+    _consumed += length;
+}
+
+// Copies length bytes, which can span blocks.  Returns false at end of file.
+bool InputFile::readExactly(char* buffer, size_t length) {
+    while (length) {
+        const char* data;
+        size_t      n = nextData(data);
+        if (!n) {
+            return false;
+        }
+        if (n > length) {
+            n = length;
+        }
+        memcpy(buffer, data, n);
+        advance(n);
+        buffer += n;
+        length -= n;
+    }
+    return true;
+}
 
-InputFile::InputFile(const char* defaultFs, const char* path, WebUI::AuthenticationLevel auth_level, Channel& out) :
-    FileStream(path, "r", defaultFs), _auth_level(auth_level), _out(out), _line_num(0) {}
 /*
   Read a line from the file
   Returns Error::Ok if a line was read, even if the line was empty.
   Returns Error::EOF on end of file.
+  Returns Error::Reset if a reset stopped the wait for the file, as the line could be cut short.
   Returns other Error code on error, after displaying a message.
 */
 Error InputFile::readLine(char* line, int maxlen) {
+    Error err = readText(line, maxlen);
+    return _aborted ? Error::Reset : err;
+}
+
+Error InputFile::readText(char* line, int maxlen) {
+    if (_format == Format::Unknown) {
+        const char* data;
+        size_t      length = nextData(data);
+        _format            = Format::Text;
+        if (CompiledGCode::isCompiled(data, length)) {
+            if (uint8_t(data[4]) != CompiledGCode::version) {
+                return Error::FsFailedRead;
+            }
+            _format = Format::Compiled;
+            advance(CompiledGCode::headerSize);
+        }
+    }
+    if (_format == Format::Compiled) {
+        return readRecord(line, maxlen);
+    }
+
     ++_line_num;
-    int len = 0;
-    int c;
-    while ((c = read()) >= 0) {
-        if (len >= maxlen) {
-            return Error::LineLengthExceeded;
+    int  len     = 0;
+    bool gotData = false;
+    while (true) {
+        const char* start;
+        size_t      n = nextData(start);
+        if (!n) {
+            break;  // End of file
         }
-        if (c == '\r') {
-            continue;
+        gotData = true;
+
+        // Copy up to the newline or the end of the block, whichever comes first
+        const char* newline = static_cast<const char*>(memchr(start, '\n', n));
+        if (newline) {
+            n = newline - start;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            char c = start[i];
+            if (c == '\r') {
+                continue;
+            }
+            if (len >= maxlen) {
+                return Error::LineLengthExceeded;
+            }
+            line[len++] = c;
         }
-        if (c == '\n') {
+        if (newline) {
+            advance(n + 1);
             break;
         }
-        line[len++] = c;
+        advance(n);
     }
     line[len] = '\0';
-    return len || c >= 0 ? Error::Ok : Error::Eof;
+    return gotData ? Error::Ok : Error::Eof;
+}
+
+// Reads a record of a compiled job.  A block is decoded into the pending block,
+// leaving only a blockMarker in line for gc_execute_line(); text is passed on as a line.
+Error InputFile::readRecord(char* line, int maxlen) {
+    uint8_t record[CompiledGCode::recordSize];
+    if (!readExactly(reinterpret_cast<char*>(record), sizeof(record))) {
+        return Error::Eof;
+    }
+    _line_num     = CompiledGCode::getUint32(record);
+    uint8_t count = record[4];
+
+    if (count == CompiledGCode::textRecord) {
+        uint8_t length;
+        if (!readExactly(reinterpret_cast<char*>(&length), 1)) {
+            return Error::FsFailedRead;
+        }
+        if (length > maxlen) {
+            return Error::LineLengthExceeded;
+        }
+        if (!readExactly(line, length)) {
+            return Error::FsFailedRead;
+        }
+        line[length] = '\0';
+        return Error::Ok;
+    }
+
+    if (count > CompiledGCode::maxWords) {
+        return Error::LineLengthExceeded;
+    }
+    uint8_t words[CompiledGCode::maxWords * CompiledGCode::wordSize];
+    size_t  length = count * CompiledGCode::wordSize;
+    if (!readExactly(reinterpret_cast<char*>(words), length) || !CompiledGCode::setBlock(words, length)) {
+        return Error::FsFailedRead;
+    }
+    line[0] = CompiledGCode::blockMarker;
+    line[1] = '\0';
+    return Error::Ok;
 }
 
 // return a percentage complete 50.5 = 50.5%
 float InputFile::percent_complete() {
-    return (float)position() / (float)size() * 100.0f;
+    return (float)_consumed / (float)size() * 100.0f;
 }
 
 void InputFile::ack(Error status) {
@@ -52,10 +259,21 @@ void InputFile::ack(Error status) {
     _readyNext = true;
 }
 
-std::string InputFile::_progress = "";
+std::string InputFile::_progressPath;
+size_t      InputFile::_progressSize     = 0;
+size_t      InputFile::_progressPosition = 0;
 
-#include <sstream>
-#include <iomanip>
+void InputFile::report_progress(Print& out) {
+    if (_progressSize) {
+        out << "|SD:";
+        report_fixed(out, (float)_progressPosition / (float)_progressSize * 100.0f, 2);
+        out << "," << _progressPath;
+    }
+}
+
+void InputFile::endProgress() {
+    _progressSize = 0;
+}
 
 Channel* InputFile::pollLine(char* line) {
     // File input never returns realtime characters, so we do nothing
@@ -64,20 +282,21 @@ Channel* InputFile::pollLine(char* line) {
         return nullptr;
     }
     switch (auto err = readLine(line, Channel::maxLine)) {
-        case Error::Ok: {
-            std::ostringstream s;
-            s << "SD:" << std::fixed << std::setprecision(2) << percent_complete() << "," << path().c_str();
-            _progress = s.str();
-        }
+        case Error::Ok:
+            if (!_progressSize) {
+                _progressPath = path();
+                _progressSize = size();
+            }
+            _progressPosition = _consumed;
             return &allChannels;
         case Error::Eof:
-            _progress = "";
+            endProgress();
             _notifyf("File job done", "%s file job succeeded", path());
             log_msg(path() << " file job succeeded");
             allChannels.kill(this);
             return nullptr;
         default:
-            _progress = "";
+            endProgress();
             log_error(static_cast<int>(err) << " (" << errorString(err) << ") in " << path() << " at line " << getLineNumber());
             allChannels.kill(this);
             return nullptr;
@@ -88,10 +307,17 @@ void InputFile::stopJob() {
     //Report print stopped
     _notifyf("File print canceled", "Reset during file job at line: %d", getLineNumber());
     log_info("Reset during file job at line: " << getLineNumber());
-    _progress = "";
+    endProgress();
     allChannels.kill(this);
 }
 
 InputFile::~InputFile() {
-    _progress = "";
+    endProgress();
+    // A block that was read but not run must not be taken by a later line
+    CompiledGCode::dropBlock();
+    // The reader task might still be filling a block
+    waitBlock(0);
+    waitBlock(1);
+    delete[] _blocks[0];
+    delete[] _blocks[1];
 }
@@ -4,7 +4,13 @@
 // InputFile is used for executing and displaying GCode from a file.
 // The file can be located on any supported file system, such as SD card or the local file system.
 // InputFile inherits from FileStream, adding the following features:
-//  - Reads lines delimited by newline
+//  - Reads lines delimited by newline, from blocks of the file.  For a job, the
+//    blocks are large and are read by a background task, one block ahead of the
+//    lines being taken, so a line is usually taken from memory without waiting
+//    for the file system.  Other files, such as macros, use small blocks that are
+//    read as they are needed.
+//  - Reads the blocks of compiled jobs, which are passed to gc_execute_line()
+//    without being parsed again.
 //  - For reporting the progress of GCode execution, counts the number of lines read and
 //    the percentage of the file size that has currently been read.
 //  - For reporting status, remembers the I/O channel that started the process of using the file.
@@ -17,7 +23,9 @@
 #include "FileStream.h"  // FileStream and Channel
 #include "Error.h"
 
+#include <atomic>
 #include <cstdint>
+#include <string>
 
 class InputFile : public FileStream {
 private:
@@ -30,13 +38,59 @@ private:
     uint32_t _line_num;  // the most recent line number read
     bool     _readyNext = true;
 
+    // Lines are taken from _blocks[_current].  With read-ahead, the reader task
+    // fills the other one meanwhile, and a length of pending means that a read is
+    // in flight.  Without it, a block is filled when it is needed.
+    static const size_t  readAheadBlockSize = 4096;
+    static const size_t  directBlockSize    = 256;
+    static const int32_t pending            = -1;
+
+    bool                 _readAhead;
+    size_t               _blockSize;
+    bool                 _aborted = false;  // A wait for the reader task was cut short by a reset
+    char*                _blocks[2];
+    std::atomic<int32_t> _lengths[2];
+    int                  _current  = 0;
+    size_t               _offset   = 0;  // Next byte in the current block
+    size_t               _consumed = 0;  // Bytes of the file that have been taken as lines
+
+    void   requestBlock(int block);
+    void   waitBlock(int block);
+    size_t nextData(const char*& data);
+    void   advance(size_t length);
+    bool   readExactly(char* buffer, size_t length);
+
+    // A compiled job (see CompiledGCode.h) is recognized when the first line is read
+    enum class Format : uint8_t {
+        Unknown,
+        Text,
+        Compiled,
+    };
+    Format _format = Format::Unknown;
+
+    Error readText(char* line, int maxlen);
+    Error readRecord(char* line, int maxlen);
+
+    // Progress of the file job that last returned a line.  It is formatted only
+    // when a status report asks for it.
+    static std::string _progressPath;
+    static size_t      _progressSize;  // 0 when no file job is running
+    static size_t      _progressPosition;
+
+    void endProgress();
+
 public:
-    static std::string _progress;
+    // Called by the reader task
+    void fill(int block);
+
+    // Adds the "|SD:percent,path" field to a status report if a file job is running
+    static void report_progress(Print& out);
 
     // fsname is the default file system on which the file is located, in case the path does not specify
     // path is the full path to the file
     // channel is the I/O channel on which status about the use of this file will be reported
-    InputFile(const char* fsname, const char* path, WebUI::AuthenticationLevel auth_level, Channel& channel);
+    // readAhead reads the file ahead of the lines in a background task, for file jobs
+    InputFile(const char* fsname, const char* path, WebUI::AuthenticationLevel auth_level, Channel& channel, bool readAhead = false);
 
     InputFile(const InputFile&) = delete;
     InputFile& operator=(const InputFile&) = delete;
@@ -52,6 +106,8 @@ public:
     // data, you either get it "immediately" or you get a response
     // saying you will never get it (error or end-of-file).
 
+    // A line can have up to len characters, so line must hold len + 1.
+
     Error readLine(char* line, int len);
 
     // These are used for feedback about the progress of the operation
@@ -32,6 +32,21 @@ You will be ablr to add your kinematic using the config file.
 namespace Kinematics {
     class KinematicSystem;
 
+    // Adaptive segmentation, for kinematics whose motor positions are not linear in
+    // cartesian space.  The planner moves the motors linearly between segment ends, so
+    // the tool strays from the programmed line.  Each segment is made as long as it can
+    // be while that error stays within a tolerance: after a segment that fits the next
+    // one tries twice the length, and a segment that does not fit is halved.  The error
+    // is measured by putting motor positions interpolated at segment_samples through the
+    // forward kinematics.  A segment is never shorter than the fixed segment length, so
+    // where the transform bends sharply moves are split as finely as they were before.
+    //
+    // The middle is sampled first, as it is where the error is largest for a smooth
+    // transform; the quarter points catch error that is lopsided, or changes sign, within
+    // a long segment.  Error between the samples is not checked.
+    const float  segment_samples[] = { 0.5f, 0.25f, 0.75f };
+    const size_t n_segment_samples = sizeof(segment_samples) / sizeof(segment_samples[0]);
+
     class Kinematics : public Configuration::Configurable {
     public:
         Kinematics() {}
@@ -54,6 +69,7 @@ namespace Kinematics {
             float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc);
 
         bool canHome(AxisMask axisMask);
+        bool canPlanArcs();
         bool kinematics_homing(AxisMask axisMask);
         void releaseMotors(AxisMask axisMask, MotorMask motors);
         bool limitReached(AxisMask& axisMask, MotorMask& motors, MotorMask limited);
@@ -88,6 +104,8 @@ namespace Kinematics {
         virtual bool transform_cartesian_to_motors(float* motors, float* cartesian) = 0;
 
         virtual bool canHome(AxisMask axisMask) { return false; }
+        // True if arcs can go to the planner whole, which needs motor space to be cartesian space.
+        virtual bool canPlanArcs() { return false; }
         virtual void releaseMotors(AxisMask axisMask, MotorMask motors) {}
         virtual bool limitReached(AxisMask& axisMask, MotorMask& motors, MotorMask limited) { return false; }
         virtual bool kinematics_homing(AxisMask& axisMask) { return false; }
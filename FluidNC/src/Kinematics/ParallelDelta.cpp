@@ -74,6 +74,7 @@ namespace Kinematics {
         handler.item("linkage_mm", re, 20.0, 500.0);
         handler.item("end_effector_triangle_mm", e, 20.0, 500.0);
         handler.item("kinematic_segment_len_mm", _kinematic_segment_len_mm, 0.05, 20.0);  //
+        handler.item("kinematic_tolerance_mm", _kinematic_tolerance_mm, 0.0, 1.0);
         handler.item("homing_mpos_radians", _homing_mpos);
         handler.item("soft_limits", _softLimits);
         handler.item("max_z_mm", _max_z, -10000.0, 0.0);  //
@@ -95,6 +96,11 @@ namespace Kinematics {
             }
         }
 
+        _crank_y  = -0.5f * tan30 * f;
+        _effector = 0.5f * tan30 * e;
+        _rf2      = rf * rf;
+        _k        = _rf2 - re * re - _crank_y * _crank_y;
+
         init_position();
     }
 
@@ -154,9 +160,10 @@ namespace Kinematics {
         float dx, dy, dz;  // distances in each cartesian axis
         float motor_angles[3];
 
-        float seg_target[3];                    // The target of the current segment
-        float feed_rate  = pl_data->feed_rate;  // save original feed rate
-        bool  show_error = true;                // shows error once
+        float seg_x[batchSize], seg_y[batchSize], seg_z[batchSize];  // The targets of a batch of segments
+        float seg_angles[3][batchSize];                               // and their motor angles
+
+        float feed_rate = pl_data->feed_rate;  // save original feed rate
 
         bool calc_ok = true;
 
@@ -190,38 +197,129 @@ namespace Kinematics {
         dz         = target[Z_AXIS] - position[Z_AXIS];
         float dist = sqrt((dx * dx) + (dy * dy) + (dz * dz));
 
+        if (_kinematic_tolerance_mm > 0 && dist > 0) {
+            return adaptive_segments(target, pl_data, position, dist);
+        }
+
         // determine the number of segments we need	... round up so there is at least 1 (except when dist is 0)
         uint32_t segment_count = ceil(dist / _kinematic_segment_len_mm);
 
         float segment_dist = dist / ((float)segment_count);  // distance of each segment...will be used for feedrate conversion
 
-        for (uint32_t segment = 1; segment <= segment_count; segment++) {
-            if (sys.abort) {
-                return true;
+        for (uint32_t first = 1; first <= segment_count; first += batchSize) {
+            // determine the targets of the segments in this batch
+            int n = segment_count - first < batchSize ? segment_count - first + 1 : batchSize;
+            for (int i = 0; i < n; i++) {
+                uint32_t segment = first + i;
+                seg_x[i]         = position[X_AXIS] + (dx / float(segment_count) * segment);
+                seg_y[i]         = position[Y_AXIS] + (dy / float(segment_count) * segment);
+                seg_z[i]         = position[Z_AXIS] + (dz / float(segment_count) * segment);
             }
-            //log_debug("Segment:" << segment << " of " << segment_count);
-            // determine this segment's target
-            seg_target[X_AXIS] = position[X_AXIS] + (dx / float(segment_count) * segment);
-            seg_target[Y_AXIS] = position[Y_AXIS] + (dy / float(segment_count) * segment);
-            seg_target[Z_AXIS] = position[Z_AXIS] + (dz / float(segment_count) * segment);
-
-            //log_debug("Segment target (" << seg_target[0] << "," << seg_target[1] << "," << seg_target[2] << ")");
 
             // calculate the delta motor angles
-            bool calc_ok = transform_cartesian_to_motors(motor_angles, seg_target);
+            int reachable = batch_to_motors(seg_x, seg_y, seg_z, seg_angles, n);
 
-            if (!calc_ok) {
-                if (show_error) {
+            for (int i = 0; i < n; i++) {
+                if (sys.abort) {
+                    return true;
+                }
+                motor_angles[0] = seg_angles[0][i];
+                motor_angles[1] = seg_angles[1][i];
+                motor_angles[2] = seg_angles[2][i];
+
+                if (i == reachable) {
                     log_error("Kinematic error motors (" << motor_angles[0] << "," << motor_angles[1] << "," << motor_angles[2] << ")");
-                    show_error = false;
+                    return false;
                 }
-                return false;
+                if (pl_data->motion.rapidMotion) {
+                    pl_data->feed_rate = feed_rate;
+                } else {
+                    float delta_distance = three_axis_dist(motor_angles, last_angle);
+                    pl_data->feed_rate   = (feed_rate * delta_distance / segment_dist);
+                }
+
+                // mc_line() returns false if a jog is cancelled.
+                // In that case we stop sending segments to the planner.
+                if (!mc_move_motors(motor_angles, pl_data)) {
+                    return false;
+                }
+
+                // save angles for next distance calc
+                // This is after mc_line() so that we do not update
+                // last_angle if the segment was discarded.
+                memcpy(last_angle, motor_angles, sizeof(motor_angles));
             }
+        }
+        return true;
+    }
+
+    // Segments as long as kinematic_tolerance_mm allows, as described in Kinematics.h,
+    // with the arm angles sampled along each segment put through the forward kinematics.
+    // kinematic_segment_len_mm is the shortest segment.
+    bool ParallelDelta::adaptive_segments(float* target, plan_line_data_t* pl_data, float* position, float dist) {
+        float feed_rate = pl_data->feed_rate;  // save original feed rate
+        float delta[3]  = { target[X_AXIS] - position[X_AXIS], target[Y_AXIS] - position[Y_AXIS], target[Z_AXIS] - position[Z_AXIS] };
+
+        float motor_angles[MAX_N_AXIS] = { 0.0 };
+        float length                   = _kinematic_segment_len_mm;
+        float done                     = 0;  // distance along the move to the start of the segment
+
+        for (bool last = false; !last;) {
+            if (sys.abort) {
+                return true;
+            }
+            // Try a longer segment after each one that fits, and shorter ones until one fits
+            length *= 2;
+            while (true) {
+                float remaining = dist - done;
+                last            = length >= remaining;
+                if (last) {
+                    length = remaining;
+                }
+
+                float seg_target[3];
+                float fraction = (done + length) / dist;
+                for (int axis = 0; axis < 3; axis++) {
+                    seg_target[axis] = position[axis] + delta[axis] * fraction;
+                }
+                if (!transform_cartesian_to_motors(motor_angles, seg_target)) {
+                    log_error("Kinematic error motors (" << motor_angles[0] << "," << motor_angles[1] << "," << motor_angles[2] << ")");
+                    return false;
+                }
+                if (length <= _kinematic_segment_len_mm) {
+                    break;
+                }
+
+                float error = 0;
+                for (size_t i = 0; i < n_segment_samples && error <= _kinematic_tolerance_mm; i++) {
+                    float t                  = segment_samples[i];
+                    float angles[MAX_N_AXIS] = { 0.0 };
+                    float actual[MAX_N_AXIS] = { 0.0 };
+                    float line[3];
+                    for (int axis = 0; axis < 3; axis++) {
+                        angles[axis] = last_angle[axis] + (motor_angles[axis] - last_angle[axis]) * t;
+                    }
+                    motors_to_cartesian(actual, angles, 3);
+                    fraction = (done + length * t) / dist;
+                    for (int axis = 0; axis < 3; axis++) {
+                        line[axis] = position[axis] + delta[axis] * fraction;
+                    }
+                    error = three_axis_dist(actual, line);
+                }
+                if (error <= _kinematic_tolerance_mm) {
+                    break;
+                }
+                length /= 2;
+                if (length < _kinematic_segment_len_mm) {
+                    length = _kinematic_segment_len_mm;
+                }
+            }
+
             if (pl_data->motion.rapidMotion) {
                 pl_data->feed_rate = feed_rate;
             } else {
                 float delta_distance = three_axis_dist(motor_angles, last_angle);
-                pl_data->feed_rate   = (feed_rate * delta_distance / segment_dist);
+                pl_data->feed_rate   = (feed_rate * delta_distance / length);
             }
 
             // mc_line() returns false if a jog is cancelled.
@@ -230,10 +328,8 @@ namespace Kinematics {
                 return false;
             }
 
-            // save angles for next distance calc
-            // This is after mc_line() so that we do not update
-            // last_angle if the segment was discarded.
-            memcpy(last_angle, motor_angles, sizeof(motor_angles));
+            memcpy(last_angle, motor_angles, 3 * sizeof(float));
+            done += length;
         }
         return true;
     }
@@ -305,57 +401,59 @@ namespace Kinematics {
         return true;  // signal main code that this handled all homing
     }
 
-    // helper functions, calculates angle theta1 (for YZ-pane)
-    bool ParallelDelta::delta_calcAngleYZ(float x0, float y0, float z0, float& theta) {
-        float y1 = -0.5 * 0.57735 * f;  // f/2 * tg 30
-        y0 -= 0.5 * 0.57735 * e;        // shift center to edge
-        // z = a + b*y
-        float a = (x0 * x0 + y0 * y0 + z0 * z0 + rf * rf - re * re - y1 * y1) / (2 * z0);
-        float b = (y1 - y0) / z0;
-        // discriminant
-        float d = -(a + b * y1) * (a + b * y1) + rf * (b * b * rf + rf);
-        if (d < 0) {
-            //log_warn("Kinematics: Target unreachable");
-            return false;
-        }                                                 // non-existing point
-        float yj = (y1 - a * b - sqrt(d)) / (b * b + 1);  // choosing outer point
-        float zj = a + b * yj;
-
-        theta = atan(-zj / (y1 - yj)) + ((yj > y1) ? M_PI : 0.0);
+    // The angle of each arm is found in the YZ plane of that arm, so the points are
+    // first rotated by 0, +120 and -120 degrees.  The loops have no calls or early
+    // exits, so that the compiler can keep the constants in registers.
+    int ParallelDelta::batch_to_motors(const float* x, const float* y, const float* z, float angles[3][batchSize], int n) {
+        static const float cosines[3] = { 1.0f, cos120, cos120 };
+        static const float sines[3]   = { 0.0f, sin120, -sin120 };
+
+        int reachable = n;
+        for (int arm = 0; arm < 3; arm++) {
+            float  c     = cosines[arm];
+            float  s     = sines[arm];
+            float* theta = angles[arm];
+            for (int i = 0; i < n; i++) {
+                float x0 = x[i] * c + y[i] * s;
+                float y0 = y[i] * c - x[i] * s - _effector;  // shift center to edge
+                float z0 = z[i];
+                // z = a + b*y
+                float a = (x0 * x0 + y0 * y0 + z0 * z0 + _k) / (2 * z0);
+                float b = (_crank_y - y0) / z0;
+                // discriminant
+                float ab = a + b * _crank_y;
+                float b1 = b * b + 1;
+                float d  = _rf2 * b1 - ab * ab;
+                if (d < 0 && i < reachable) {
+                    reachable = i;  // non-existing point
+                }
+                float yj = (_crank_y - a * b - sqrtf(d > 0 ? d : 0)) / b1;  // choosing outer point
+                float zj = a + b * yj;
 
-        return true;
+                theta[i] = atanf(-zj / (_crank_y - yj)) + ((yj > _crank_y) ? float(M_PI) : 0.0f);
+            }
+        }
+        return reachable;
     }
 
     void ParallelDelta::releaseMotors(AxisMask axisMask, MotorMask motors) {}
 
     bool ParallelDelta::transform_cartesian_to_motors(float* motors, float* cartesian) {
         motors[0] = motors[1] = motors[2] = 0;
-        bool calc_ok                      = false;
 
         if (cartesian[Z_AXIS] > _max_z) {
             log_debug("Kinematics transform error. Target:" << cartesian[Z_AXIS] << " exceeds max_z:" << _max_z);
             return false;
         }
 
-        calc_ok = delta_calcAngleYZ(cartesian[X_AXIS], cartesian[Y_AXIS], cartesian[Z_AXIS], motors[0]);
-        if (!calc_ok) {
-            return calc_ok;
-        }
-
-        calc_ok = delta_calcAngleYZ(cartesian[X_AXIS] * cos120 + cartesian[Y_AXIS] * sin120,
-                                    cartesian[Y_AXIS] * cos120 - cartesian[X_AXIS] * sin120,
-                                    cartesian[Z_AXIS],
-                                    motors[1]);  // rotate coords to +120 deg
-        if (!calc_ok) {
-            return calc_ok;
+        float angles[3][batchSize];
+        if (batch_to_motors(&cartesian[X_AXIS], &cartesian[Y_AXIS], &cartesian[Z_AXIS], angles, 1) != 1) {
+            return false;
         }
-
-        calc_ok = delta_calcAngleYZ(cartesian[X_AXIS] * cos120 - cartesian[Y_AXIS] * sin120,
-                                    cartesian[Y_AXIS] * cos120 + cartesian[X_AXIS] * sin120,
-                                    cartesian[Z_AXIS],
-                                    motors[2]);  // rotate coords to -120 deg
-
-        return calc_ok;
+        motors[0] = angles[0][0];
+        motors[1] = angles[1][0];
+        motors[2] = angles[2][0];
+        return true;
     }
 
     // Determine the unit distance between (2) 3D points
@@ -70,14 +70,29 @@ namespace Kinematics {
         float e  = 86.603;
 
         float _kinematic_segment_len_mm = 1.0;  // the maximun segment length the move is broken into
+        float _kinematic_tolerance_mm   = 0.0;  // if not 0, segments are as long as this error allows
         bool  _softLimits               = false;
         float _homing_mpos              = 0.0;
         float _max_z                    = 0.0;
         bool  _use_servos               = true;  // servo use a special homing
 
-        bool  delta_calcAngleYZ(float x0, float y0, float z0, float& theta);
+        // The segments of a move are converted in batches, with the coordinates in
+        // separate arrays, so that the angles of each arm are computed in one loop
+        static const int batchSize = 16;
+
+        // Inverse kinematics constants, computed from the geometry by init()
+        float _crank_y;   // Y of the crank axis, f/2 * tan 30
+        float _effector;  // Y of the end effector joint, e/2 * tan 30
+        float _rf2;       // rf^2
+        float _k;         // rf^2 - re^2 - _crank_y^2
+
+        // Computes the motor angles of n points, n <= batchSize.  Returns the number
+        // of points, from the first one, that every arm can reach.
+        int   batch_to_motors(const float* x, const float* y, const float* z, float angles[3][batchSize], int n);
         float three_axis_dist(float* point1, float* point2);
 
+        bool adaptive_segments(float* target, plan_line_data_t* pl_data, float* position, float dist);
+
     protected:
     };
 }  //  namespace Kinematics
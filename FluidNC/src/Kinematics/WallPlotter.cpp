@@ -15,6 +15,7 @@ namespace Kinematics {
         handler.item("right_anchor_y", _right_anchor_y);
 
         handler.item("segment_length", _segment_length);
+        handler.item("segment_tolerance", _segment_tolerance, 0.0, 10.0);
     }
 
     void WallPlotter::init() {
@@ -80,6 +81,9 @@ namespace Kinematics {
         // Z axis is the same in both coord systems, so it does not undergo conversion
         float xydist = vector_distance(target, position, 2);  // Only compute distance for both axes. X and Y
         // Segment our G1 and G0 moves based on yaml file. If we choose a small enough _segment_length we can hide the nonlinearity
+        if (_segment_tolerance > 0 && xydist > _segment_length) {
+            return adaptive_segments(target, pl_data, position, xydist, total_cartesian_distance);
+        }
         segment_count = xydist / _segment_length;
         if (segment_count < 1) {  // Make sure there is at least one segment, even if there is no movement
             // We need to do this to make sure other things like S and M codes get updated properly by
@@ -97,11 +101,32 @@ namespace Kinematics {
         float cartesian_segment_end[n_axis];
         copyAxes(cartesian_segment_end, position);
 
+        // The X,Y end points of a batch of segments, and their cord lengths
+        float batch_x[batchSize], batch_y[batchSize];
+        float batch_left[batchSize], batch_right[batchSize];
+        float next_x = position[X_AXIS];
+        float next_y = position[Y_AXIS];
+        int   batch  = 0;
+        int   count  = 0;
+
         // Calculate desired cartesian feedrate distance ratio. Same for each seg.
         for (uint32_t segment = 1; segment <= segment_count; segment++) {
             if (sys.abort) {
                 return true;
             }
+            if (batch == count) {
+                // Convert the X,Y end points of the next batch to motor space
+                count = segment_count - segment < batchSize ? segment_count - segment + 1 : batchSize;
+                for (int i = 0; i < count; i++) {
+                    next_x += cartesian_segment_components[X_AXIS];
+                    next_y += cartesian_segment_components[Y_AXIS];
+                    batch_x[i] = next_x;
+                    batch_y[i] = next_y;
+                }
+                batch_to_lengths(batch_x, batch_y, batch_left, batch_right, count);
+                batch = 0;
+            }
+
             // calculate the cartesian end point of the next segment
             for (size_t axis = X_AXIS; axis < n_axis; axis++) {
                 cartesian_segment_end[axis] += cartesian_segment_components[axis];
@@ -109,7 +134,9 @@ namespace Kinematics {
 
             // Convert cartesian space coords to motor space
             float motor_segment_end[n_axis];
-            xy_to_lengths(cartesian_segment_end[X_AXIS], cartesian_segment_end[Y_AXIS], motor_segment_end[0], motor_segment_end[1]);
+            motor_segment_end[0] = batch_left[batch];
+            motor_segment_end[1] = batch_right[batch];
+            ++batch;
             for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
                 motor_segment_end[axis] = cartesian_segment_end[axis];
             }
@@ -123,35 +150,114 @@ namespace Kinematics {
                 // FIX: Produce an alarm state?
             }
 #endif
-            // Adjust feedrate by the ratio of the segment lengths in motor and cartesian spaces,
-            // accounting for all axes
-            if (!pl_data->motion.rapidMotion) {  // Rapid motions ignore feedrate. Don't convert.
-                                                 // T=D/V, Tcart=Tmotor, Dcart/Vcart=Dmotor/Vmotor
-                                                 // Vmotor = Dmotor*(Vcart/Dcart)
-                float motor_segment_length = vector_distance(last_motor_segment_end, motor_segment_end, n_axis);
-                pl_data->feed_rate         = cartesian_feed_rate * motor_segment_length / cartesian_segment_length;
+            if (!move_segment(motor_segment_end, cartesian_segment_end, cartesian_segment_length, cartesian_feed_rate, pl_data)) {
+                return false;
             }
+        }
+        return true;
+    }
+
+    // Sends a segment to the planner, given its end in motor and cartesian spaces
+    bool WallPlotter::move_segment(float*            motor_segment_end,
+                                   float*            cartesian_segment_end,
+                                   float             cartesian_segment_length,
+                                   float             cartesian_feed_rate,
+                                   plan_line_data_t* pl_data) {
+        auto n_axis = config->_axes->_numberAxis;
+
+        // Adjust feedrate by the ratio of the segment lengths in motor and cartesian spaces,
+        // accounting for all axes
+        if (!pl_data->motion.rapidMotion) {  // Rapid motions ignore feedrate. Don't convert.
+                                             // T=D/V, Tcart=Tmotor, Dcart/Vcart=Dmotor/Vmotor
+                                             // Vmotor = Dmotor*(Vcart/Dcart)
+            float motor_segment_length = vector_distance(last_motor_segment_end, motor_segment_end, n_axis);
+            pl_data->feed_rate         = cartesian_feed_rate * motor_segment_length / cartesian_segment_length;
+        }
+
+        // TODO: G93 pl_data->motion.inverseTime logic?? Does this even make sense for wallplotter?
+
+        // Remember the last motor position so the length can be computed the next time
+        copyAxes(last_motor_segment_end, motor_segment_end);
+
+        // Initiate motor movement with converted feedrate and converted position
+        // mc_move_motors() returns false if a jog is cancelled.
+        // In that case we stop sending segments to the planner.
+        // Note that the left motor runs backward.
+        // TODO: It might be better to adjust motor direction in .yaml file by inverting direction pin??
+        float cables[n_axis];
+        cables[0] = 0 - (motor_segment_end[0] - zero_left);
+        cables[1] = 0 + (motor_segment_end[1] - zero_right);
+        for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
+            cables[axis] = cartesian_segment_end[axis];
+        }
+        // TODO fixup last_left last_right?? What is position state when jog is cancelled?
+        return mc_move_motors(cables, pl_data);
+    }
 
-            // TODO: G93 pl_data->motion.inverseTime logic?? Does this even make sense for wallplotter?
+    // Segments as long as segment_tolerance allows, as described in Kinematics.h, with
+    // the cord lengths sampled along each segment put through lengths_to_xy().
+    // segment_length is the shortest segment.
+    bool WallPlotter::adaptive_segments(float* target, plan_line_data_t* pl_data, float* position, float xydist, float total_distance) {
+        auto n_axis = config->_axes->_numberAxis;
 
-            // Remember the last motor position so the length can be computed the next time
-            copyAxes(last_motor_segment_end, motor_segment_end);
+        float cartesian_feed_rate = pl_data->feed_rate;
 
-            // Initiate motor movement with converted feedrate and converted position
-            // mc_move_motors() returns false if a jog is cancelled.
-            // In that case we stop sending segments to the planner.
-            // Note that the left motor runs backward.
-            // TODO: It might be better to adjust motor direction in .yaml file by inverting direction pin??
-            float cables[n_axis];
-            cables[0] = 0 - (motor_segment_end[0] - zero_left);
-            cables[1] = 0 + (motor_segment_end[1] - zero_right);
+        float motor_segment_end[n_axis];
+        float cartesian_segment_end[n_axis];
+        float length = _segment_length;
+        float done   = 0;  // X,Y distance along the move to the start of the segment
+
+        for (bool last = false; !last;) {
+            if (sys.abort) {
+                return true;
+            }
+            // Try a longer segment after each one that fits, and shorter ones until one fits
+            length *= 2;
+            while (true) {
+                float remaining = xydist - done;
+                last            = length >= remaining;
+                if (last) {
+                    length = remaining;
+                }
+
+                float fraction = (done + length) / xydist;
+                for (size_t axis = X_AXIS; axis < n_axis; axis++) {
+                    cartesian_segment_end[axis] = position[axis] + (target[axis] - position[axis]) * fraction;
+                }
+                xy_to_lengths(cartesian_segment_end[X_AXIS], cartesian_segment_end[Y_AXIS], motor_segment_end[0], motor_segment_end[1]);
+                if (length <= _segment_length) {
+                    break;
+                }
+
+                float error = 0;
+                for (size_t i = 0; i < n_segment_samples && error <= _segment_tolerance; i++) {
+                    float t = segment_samples[i];
+                    float x, y;
+                    lengths_to_xy(last_motor_segment_end[0] + (motor_segment_end[0] - last_motor_segment_end[0]) * t,
+                                  last_motor_segment_end[1] + (motor_segment_end[1] - last_motor_segment_end[1]) * t,
+                                  x,
+                                  y);
+                    fraction = (done + length * t) / xydist;
+                    error    = hypot_f(x - (position[X_AXIS] + (target[X_AXIS] - position[X_AXIS]) * fraction),
+                                       y - (position[Y_AXIS] + (target[Y_AXIS] - position[Y_AXIS]) * fraction));
+                }
+                if (error <= _segment_tolerance) {
+                    break;
+                }
+                length /= 2;
+                if (length < _segment_length) {
+                    length = _segment_length;
+                }
+            }
             for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
-                cables[axis] = cartesian_segment_end[axis];
+                motor_segment_end[axis] = cartesian_segment_end[axis];
             }
-            if (!mc_move_motors(cables, pl_data)) {
-                // TODO fixup last_left last_right?? What is position state when jog is cancelled?
+
+            float cartesian_segment_length = total_distance * length / xydist;
+            if (!move_segment(motor_segment_end, cartesian_segment_end, cartesian_segment_length, cartesian_feed_rate, pl_data)) {
                 return false;
             }
+            done += length;
         }
         return true;
     }
@@ -233,6 +339,19 @@ namespace Kinematics {
         right_length   = hypot_f(right_dx, right_dy);
     }
 
+    void WallPlotter::batch_to_lengths(const float* x, const float* y, float* left_length, float* right_length, int n) {
+        for (int i = 0; i < n; i++) {
+            float left_dy  = _left_anchor_y - y[i];
+            float left_dx  = _left_anchor_x - x[i];
+            left_length[i] = sqrtf(left_dx * left_dx + left_dy * left_dy);
+        }
+        for (int i = 0; i < n; i++) {
+            float right_dy  = _right_anchor_y - y[i];
+            float right_dx  = _right_anchor_x - x[i];
+            right_length[i] = sqrtf(right_dx * right_dx + right_dy * right_dy);
+        }
+    }
+
     bool WallPlotter::kinematics_homing(AxisMask& axisMask) {
         return false;  // kinematics does not do the homing for catesian systems
     }
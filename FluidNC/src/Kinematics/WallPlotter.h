@@ -45,6 +45,19 @@ namespace Kinematics {
         void lengths_to_xy(float left_length, float right_length, float& x, float& y);
         void xy_to_lengths(float x, float y, float& left_length, float& right_length);
 
+        // The segments of a move are converted in batches, so that the cord
+        // lengths of a batch are computed in one loop over arrays
+        static const int batchSize = 16;
+
+        void batch_to_lengths(const float* x, const float* y, float* left_length, float* right_length, int n);
+
+        bool move_segment(float*            motor_segment_end,
+                          float*            cartesian_segment_end,
+                          float             cartesian_segment_length,
+                          float             cartesian_feed_rate,
+                          plan_line_data_t* pl_data);
+        bool adaptive_segments(float* target, plan_line_data_t* pl_data, float* position, float xydist, float total_distance);
+
         // State
         float zero_left;   //  The left cord offset corresponding to cartesian (0, 0).
         float zero_right;  //  The right cord offset corresponding to cartesian (0, 0).
@@ -55,9 +68,10 @@ namespace Kinematics {
         float _left_anchor_x = -100;
         float _left_anchor_y = 100;
 
-        int   _right_axis     = 1;
-        float _right_anchor_x = 100;
-        float _right_anchor_y = 100;
-        float _segment_length = 10;
+        int   _right_axis        = 1;
+        float _right_anchor_x    = 100;
+        float _right_anchor_y    = 100;
+        float _segment_length    = 10;
+        float _segment_tolerance = 0;  // If not 0, segments are as long as this error in mm allows
     };
 }  //  namespace Kinematics
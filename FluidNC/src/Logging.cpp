@@ -15,8 +15,86 @@ bool atMsgLevel(MsgLevel level) {
     return message_level == nullptr || message_level->get() >= level;
 }
 
-LogStream::LogStream(Channel& channel, MsgLevel level) : _channel(channel), _level(level) {
-    _line = new std::string();
+// The pool of line buffers.  The free ones are kept in a queue, so any task can
+// take one and the output task can give it back.
+static const int messageLines = 16;
+static const int waitTicks    = 2000 / portTICK_PERIOD_MS;  // How long a sender waits before dropping a message
+
+static LogLine       logLines[messageLines];
+static QueueHandle_t freeLines = nullptr;
+
+LogStats log_stats;
+
+void init_log_lines() {
+    // One spare entry, because the host model of a queue holds one less than its length
+    freeLines = xQueueCreate(messageLines + 1, sizeof(LogLine*));
+    for (auto& line : logLines) {
+        LogLine* p = &line;
+        xQueueSend(freeLines, &p, 0);
+    }
+    reset_log_stats();
+}
+
+uint32_t free_log_lines() {
+    return freeLines ? uxQueueMessagesWaiting(freeLines) : messageLines;
+}
+
+void reset_log_stats() {
+    log_stats.blocked  = 0;
+    log_stats.dropped  = 0;
+    log_stats.oversize = 0;
+    log_stats.min_free = free_log_lines();
+}
+
+// The output task is what frees line buffers and queue space, so it must not wait for them
+static TickType_t senderWait() {
+    return outputTask && xTaskGetCurrentTaskHandle() == outputTask ? 0 : waitTicks;
+}
+
+bool LogLine::pooled() {
+    return freeLines != nullptr;
+}
+
+LogLine* LogLine::alloc() {
+    if (!freeLines) {
+        return nullptr;
+    }
+    LogLine* line;
+    if (!xQueueReceive(freeLines, &line, 0)) {
+        ++log_stats.blocked;
+        if (!xQueueReceive(freeLines, &line, senderWait())) {
+            ++log_stats.dropped;
+            return nullptr;
+        }
+    }
+    uint32_t available = free_log_lines();
+    if (available < log_stats.min_free) {
+        log_stats.min_free = available;
+    }
+    line->length = 0;
+    return line;
+}
+
+void LogLine::release(LogLine* line) {
+    xQueueSend(freeLines, &line, 0);
+}
+
+bool queue_message(const LogMessage& msg) {
+    if (xQueueSend(message_queue, &msg, 0)) {
+        return true;
+    }
+    ++log_stats.blocked;
+    if (xQueueSend(message_queue, &msg, senderWait())) {
+        return true;
+    }
+    ++log_stats.dropped;
+    return false;
+}
+
+LogStream::LogStream(Channel& channel, MsgLevel level) : _channel(channel), _pooled(LogLine::alloc()), _line(nullptr), _level(level) {
+    if (!LogLine::pooled()) {
+        _line = new std::string();  // A message from before init_log_lines()
+    }
 }
 
 LogStream::LogStream(Channel& channel, MsgLevel level, const char* name) : LogStream(channel, level) {
@@ -27,13 +105,34 @@ LogStream::LogStream(Channel& channel, const char* name) : LogStream(channel, Ms
 LogStream::LogStream(MsgLevel level, const char* name) : LogStream(allChannels, level, name) {}
 
 size_t LogStream::write(uint8_t c) {
-    *_line += (char)c;
+    if (_pooled) {
+        // Leave room for the ] and the NUL
+        if (_pooled->length < LogLine::size - 2) {
+            _pooled->text[_pooled->length++] = c;
+            return 1;
+        }
+        ++log_stats.oversize;
+        _line = new std::string(_pooled->text, _pooled->length);
+        LogLine::release(_pooled);
+        _pooled = nullptr;
+    }
+    if (_line) {
+        *_line += (char)c;
+    }
     return 1;
 }
 
 LogStream::~LogStream() {
-    if ((*_line).length() && (*_line)[0] == '[') {
-        *_line += ']';
+    if (_pooled) {
+        if (_pooled->length && _pooled->text[0] == '[') {
+            _pooled->text[_pooled->length++] = ']';
+        }
+        _pooled->text[_pooled->length] = '\0';
+        _channel.sendLine(_level, _pooled);
+    } else if (_line) {
+        if ((*_line).length() && (*_line)[0] == '[') {
+            *_line += ']';
+        }
+        _channel.sendLine(_level, _line);
     }
-    _channel.sendLine(_level, _line);
 }
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <string>
 #include "EnumItem.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
@@ -19,13 +21,55 @@ enum MsgLevel {
     MsgLevelVerbose = 5,
 };
 
+// Log messages are built in a pool of fixed-size line buffers that is allocated
+// once, rather than in strings on the heap.  alloc() waits a while for a free
+// buffer - except on the output task, which never waits - and returns nullptr
+// if there is none, in which case the message is dropped.  Whoever ends up with
+// the line - normally the output task - releases it.  A message that is too
+// long for a buffer, or is logged before the pool exists, goes in a string.
+struct LogLine {
+    static const size_t size = 256;  // Including the NUL
+
+    char     text[size];
+    uint16_t length;
+
+    static LogLine* alloc();
+    static void     release(LogLine* line);
+    static bool     pooled();  // init_log_lines() has been called
+};
+
+// Creates the line buffer pool.  Called once, at the start of setup().
+void init_log_lines();
+
+// How the line of a LogMessage is stored, and so how it is reclaimed
+enum class LogKind : uint8_t {
+    Fixed,   // const char* to a string that is never freed
+    String,  // std::string* that is deleted
+    Pooled,  // LogLine* that is released
+};
+
 struct LogMessage {
     Channel* channel;
     void*    line;
     MsgLevel level;
-    bool     isString;
+    LogKind  kind;
 };
 
+// Counts of messages that could not be sent right away, shown by $Log/Stats
+struct LogStats {
+    std::atomic<uint32_t> blocked;   // Senders that had to wait for a line buffer or queue space
+    std::atomic<uint32_t> dropped;   // Messages dropped after waiting too long
+    std::atomic<uint32_t> oversize;  // Messages too long for a line buffer, which went to the heap
+    std::atomic<uint32_t> min_free;  // Fewest free line buffers seen
+};
+extern LogStats log_stats;
+
+void     reset_log_stats();
+uint32_t free_log_lines();
+
+// Queues a message for the output task.  Returns false if it was dropped.
+bool queue_message(const LogMessage& msg);
+
 extern TaskHandle_t outputTask;
 
 extern xQueueHandle message_queue;
@@ -58,7 +102,8 @@ public:
 
 private:
     Channel&     _channel;
-    std::string* _line;
+    LogLine*     _pooled;  // The line, unless it outgrew its buffer or none was free
+    std::string* _line;    // The line after it outgrew its buffer
     MsgLevel     _level;
 };
 
@@ -266,8 +266,8 @@ namespace Machine {
     bool Axes::namesToMask(const char* names, AxisMask& mask) {
         bool retval = true;
         for (int i = 0; i < strlen(names); i++) {
-            char  axisName = toupper(names[i]);
-            char* pos      = index(_names, axisName);
+            char        axisName = toupper(names[i]);
+            const char* pos      = strchr(_names, axisName);
             if (!pos) {
                 log_error("Invalid axis name " << names[i]);
                 retval = false;
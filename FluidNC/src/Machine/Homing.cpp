@@ -424,6 +424,7 @@ namespace Machine {
         mpos = get_mpos();
         log_debug("mpos transformed " << mpos[0] << "," << mpos[1] << "," << mpos[2]);
 
+        Stepper::Lock lock;
         sys.step_control = {};                     // Return step control to normal operation.
         axes->set_homing_mode(_cycleAxes, false);  // tell motors homing is done
     }
@@ -20,8 +20,14 @@
 #include "../Configuration/Validator.h"
 #include "../Configuration/AfterParse.h"
 #include "../Configuration/ParseException.h"
+#include "../Configuration/PathIndex.h"
+#include "../Configuration/Arena.h"
+#include "../Configuration/Snapshot.h"
+#include "../HashFS.h"
 #include "../Config.h"  // ENABLE_*
 
+#include <freertos/FreeRTOS.h>  // xPortGetFreeHeapSize()
+
 #include <cstdio>
 #include <cstring>
 #include <atomic>
@@ -72,12 +78,13 @@ namespace Machine {
 
         // TODO: Consider putting these under a gcode: hierarchy level? Or motion control?
         handler.item("arc_tolerance_mm", _arcTolerance, 0.001, 1.0);
+        handler.item("arc_tolerance_scale", _arcToleranceScale, 1.0, maxArcToleranceScale);
         handler.item("junction_deviation_mm", _junctionDeviation, 0.01, 1.0);
         handler.item("verbose_errors", _verboseErrors);
         handler.item("report_inches", _reportInches);
         handler.item("enable_parking_override_control", _enableParkingOverrideControl);
         handler.item("use_line_numbers", _useLineNumbers);
-        handler.item("planner_blocks", _planner_blocks, 10, 120);
+        handler.item("planner_blocks", _planner_blocks, 10, 255);
     }
 
     void MachineConfig::afterParse() {
@@ -151,6 +158,9 @@ namespace Machine {
 
     const char defaultConfig[] = "name: Default (Test Drive)\nboard: None\n";
 
+    // The free heap when load_file() started, so the file buffer is counted in the heap used by the load
+    static uint32_t heapBeforeLoad = 0;
+
     bool MachineConfig::load() {
         bool configOkay;
         // If the system crashes we skip the config file and use the default
@@ -172,6 +182,7 @@ namespace Machine {
     }
 
     bool MachineConfig::load_file(const std::string_view filename) {
+        heapBeforeLoad = xPortGetFreeHeapSize();
         try {
             FileStream file(std::string { filename }, "r", "");
 
@@ -189,20 +200,93 @@ namespace Machine {
                 return false;
             }
             log_info("Configuration file:" << filename);
+
+            // The snapshot is keyed by a hash of the contents rather than by the HashFS
+            // index, which trusts the size and time of a file, and the time restarts at boot
+            std::string hash;
+            if (config_snapshot->get()) {
+                HashFS::Hasher hasher;
+                hasher.update(reinterpret_cast<const uint8_t*>(buffer.get()), filesize);
+                hash = hasher.finish();
+                if (load_snapshot(filename, hash)) {
+                    return true;
+                }
+            }
+
             // Trimming the overall config file could influence indentation, hence false
-            return load_yaml(std::string_view { buffer.get(), filesize });
+            bool successful = load_yaml(std::string_view { buffer.get(), filesize });
+            if (successful && hash.length()) {
+                save_snapshot(filename, hash);
+            }
+            return successful;
         } catch (...) {
             log_warn("Cannot open configuration file:" << filename);
             return false;
         }
     }
 
-    bool MachineConfig::load_yaml(std::string_view input) {
-        bool successful = false;
+    static std::string snapshot_name(std::string_view filename) {
+        return std::string { filename } + ".snap";
+    }
+
+    bool MachineConfig::load_snapshot(std::string_view filename, const std::string& hash) {
+        std::string snapshot;
         try {
-            Configuration::Parser        parser(input);
-            Configuration::ParserHandler handler(parser);
+            FileStream file(snapshot_name(filename), "r", "");
+
+            auto filesize = file.size();
+            if (filesize <= 0) {
+                return false;
+            }
+            snapshot.resize(filesize);
+            if (file.read(snapshot.data(), filesize) != filesize) {
+                return false;
+            }
+        } catch (...) { return false; }
+
+        std::string_view records(snapshot);
+        size_t           arenaBytes;
+        if (!Configuration::Snapshot::matches(records, hash, arenaBytes)) {
+            log_info("Configuration snapshot is out of date");
+            return false;
+        }
+        if (!load_tree(records, true, arenaBytes)) {
+            log_info("Configuration snapshot does not fit; parsing the file");
+            return false;
+        }
+        log_info("Configuration loaded from snapshot");
+        return true;
+    }
 
+    void MachineConfig::save_snapshot(std::string_view filename, const std::string& hash) {
+        auto                  name = snapshot_name(filename);
+        std::filesystem::path path;
+        try {
+            auto snapshot = Configuration::Snapshot::write(config, hash, Configuration::Arena::bytes());
+            bool written;
+            {
+                FileStream file(name, "w", "");
+                path    = file.fpath();
+                written = file.write(reinterpret_cast<const uint8_t*>(snapshot.data()), snapshot.length()) == snapshot.length();
+            }
+            HashFS::rehash_file(path, false);
+            if (!written) {
+                log_warn("Cannot write configuration snapshot:" << name);
+                return;
+            }
+            log_info("Configuration snapshot:" << name << " " << snapshot.length() << " bytes");
+        } catch (...) { log_warn("Cannot write configuration snapshot:" << name); }
+    }
+
+    bool MachineConfig::load_yaml(std::string_view input) {
+        return load_tree(input, false, Configuration::Arena::sizeFor(input));
+    }
+
+    bool MachineConfig::load_tree(std::string_view input, bool snapshot, size_t arenaBytes) {
+        bool     successful = false;
+        uint32_t heapBefore = heapBeforeLoad ? heapBeforeLoad : xPortGetFreeHeapSize();
+        heapBeforeLoad      = 0;
+        try {
             // instance() is by reference, so we can just get rid of an old instance and
             // create a new one here:
             {
@@ -210,11 +294,24 @@ namespace Machine {
                 if (machineConfig != nullptr) {
                     delete machineConfig;
                 }
+                Configuration::Arena::open(arenaBytes);
                 machineConfig = new MachineConfig();
             }
             config = instance();
+            Configuration::PathIndex::clear();
+
+            if (snapshot) {
+                // A snapshot that does not fit leaves a partial tree, which load_yaml() replaces
+                if (!Configuration::Snapshot::read(input, config)) {
+                    Configuration::Arena::close();
+                    return false;
+                }
+            } else {
+                Configuration::Parser        parser(input);
+                Configuration::ParserHandler handler(parser);
 
-            handler.enterSection("machine", config);
+                handler.enterSection("machine", config);
+            }
 
             log_debug("Running after-parse tasks");
 
@@ -222,6 +319,7 @@ namespace Machine {
                 Configuration::AfterParse afterParse;
                 config->afterParse();
                 config->group(afterParse);
+                Configuration::Arena::sampleHeap();
             } catch (std::exception& ex) { log_error("Validation error: " << ex.what()); }
 
             log_debug("Checking configuration");
@@ -230,9 +328,10 @@ namespace Machine {
                 Configuration::Validator validator;
                 config->validate();
                 config->group(validator);
+                Configuration::Arena::sampleHeap();
             } catch (std::exception& ex) { log_error("Validation error: " << ex.what()); }
 
-            // log_info("Heap size after configuation load is " << uint32_t(xPortGetFreeHeapSize()));
+            Configuration::PathIndex::build(config);
 
             successful = (sys.state != State::ConfigAlarm);
 
@@ -257,19 +356,46 @@ namespace Machine {
             log_error("Unknown error while processing config file");
         }
 
+        Configuration::Arena::close();
+        uint32_t heapLow  = Configuration::Arena::heapLowWater();
+        uint32_t heapPeak = heapBefore > heapLow ? heapBefore - heapLow : 0;
+        log_info("Configuration sections: " << Configuration::Arena::objects() << " in " << Configuration::Arena::bytes() << " bytes, "
+                                            << Configuration::Arena::heapObjects() << " on the heap; peak heap used by load: " << heapPeak);
+
         std::atomic_thread_fence(std::memory_order::memory_order_seq_cst);
 
         return successful;
     }
 
+    // Deletes the whole tree, so that a reload frees everything that the sections own
+    // before Arena::open() reuses their memory
     MachineConfig::~MachineConfig() {
         delete _axes;
+        delete _kinematics;
+        delete _spi;
+        for (auto i2c : _i2c) {
+            delete i2c;
+        }
         delete _i2so;
+        delete _stepping;
         delete _coolant;
         delete _probe;
-        delete _sdCard;
-        delete _spi;
         delete _control;
+        delete _userOutputs;
+        delete _sdCard;
         delete _macros;
+        delete _start;
+        delete _parking;
+        delete _oled;
+        delete _stat_out;
+        for (auto spindle : _spindles) {
+            delete spindle;
+        }
+        for (auto channel : _uart_channels) {
+            delete channel;
+        }
+        for (auto uart : _uarts) {
+            delete uart;
+        }
     }
 }
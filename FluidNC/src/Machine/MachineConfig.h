@@ -83,10 +83,17 @@ namespace Machine {
 
         float _arcTolerance      = 0.002f;
         float _junctionDeviation = 0.01f;
+
+        // Arc chords are made longer than arc_tolerance_mm calls for when they would be shorter than one
+        // step segment, or too short to keep the planner buffer supplied. This caps the resulting chord
+        // error as a multiple of arc_tolerance_mm, from 1 (no longer chords) to maxArcToleranceScale.
+        static constexpr float maxArcToleranceScale = 4.0f;
+        float                  _arcToleranceScale   = 1.0f;
+
         bool  _verboseErrors     = false;
         bool  _reportInches      = false;
 
-        size_t _planner_blocks = 16;
+        uint32_t _planner_blocks = 16;
 
         // Enables a special set of M-code commands that enables and disables the parking motion.
         // These are controlled by `M56`, `M56 P1`, or `M56 Px` to enable and `M56 P0` to disable.
@@ -115,6 +122,14 @@ namespace Machine {
         static bool load_yaml(std::string_view yaml_string);
 
         ~MachineConfig();
+
+    private:
+        // Builds a new tree from YAML text, or from the records of a snapshot
+        static bool load_tree(std::string_view input, bool snapshot, size_t arenaBytes);
+
+        // The snapshot of a configuration file is saved beside it with .snap added to its name
+        static bool load_snapshot(std::string_view filename, const std::string& hash);
+        static void save_snapshot(std::string_view filename, const std::string& hash);
     };
 }
 
@@ -30,6 +30,7 @@ extern void make_user_commands();
 void setup() {
     disableCore0WDT();
     try {
+        init_log_lines();
         timing_init();
         uartInit();  // Setup serial port
 
@@ -14,6 +14,7 @@
 #include "I2SOut.h"          // i2s_out_reset
 #include "Platform.h"        // WEAK_LINK
 #include "Settings.h"        // coords
+#include "StepperPrivate.h"  // DT_SEGMENT
 
 #include <cmath>
 
@@ -28,8 +29,22 @@
 // this is needed if a jogCancel comes along after we have already parsed a jog and it is in-flight.
 static volatile void* mc_pl_data_inflight;  // holds a plan_line_data_t while mc_move_motors has taken ownership of a line motion
 
+// Path blending for continuous mode (G64). Each feed move is held back until the next one arrives,
+// so that the corner between them can be cut by an arc that stays within the path tolerance. The held
+// move is sent when a move that cannot be blended arrives, when the planner is synchronized, and when
+// the planner runs dry.
+static struct {
+    bool             pending;
+    float            start[MAX_N_AXIS];     // Start of the held move, after any blend at its start
+    float            end[MAX_N_AXIS];       // Corner at the end of the held move
+    float            unit_vec[MAX_N_AXIS];  // Direction of the held move
+    float            max_trim;              // Most that a blend may cut from the end of the held move (mm)
+    plan_line_data_t pl_data;
+} blend;
+
 void mc_init() {
     mc_pl_data_inflight = NULL;
+    blend.pending       = false;
 }
 
 // Execute linear motor motion in absolute millimeter coordinates. Feed rate given in
@@ -107,15 +122,230 @@ void mc_cancel_jog() {
 static bool mc_linear_no_check(float* target, plan_line_data_t* pl_data, float* position) {
     return config->_kinematics->cartesian_to_motors(target, pl_data, position);
 }
+
+static bool mc_blendable(plan_line_data_t* pl_data) {
+    return pl_data->path_tolerance > 0.0f && !pl_data->motion.rapidMotion && !pl_data->motion.inverseTime &&
+           !pl_data->motion.systemMotion && !pl_data->is_jog;
+}
+
+// Blended moves lie inside the corners of the checked moves, so they need no soft limit check.
+static void mc_blend_send(float* target, float* position) {
+    plan_line_data_t pl_data = blend.pl_data;  // Kinematics may alter the feed rate
+    mc_linear_no_check(target, &pl_data, position);
+}
+
+void mc_flush_blend() {
+    if (blend.pending) {
+        blend.pending = false;
+        mc_blend_send(blend.end, blend.start);
+    }
+}
+
+// Sends the held move up to the start of an arc that turns it into the direction of unit_vec, then
+// the arc, leaving the end of the arc in arc_end. Returns false, sending nothing, if a blend would
+// not let the machine take the corner any faster.
+static bool mc_blend_corner(float* unit_vec, float max_trim, float* arc_end) {
+    auto  n_axis   = config->_axes->_numberAxis;
+    float cos_turn = 0.0f;
+    for (size_t i = 0; i < n_axis; i++) {
+        cos_turn += blend.unit_vec[i] * unit_vec[i];
+    }
+    if (cos_turn > 0.999999f || cos_turn < -0.999999f) {
+        return false;  // Straight on, or straight back.
+    }
+    // An arc of radius r that is tangent to both moves touches them r*tan(turn/2) from the corner,
+    // and passes r*(1/cos(turn/2) - 1) inside it. The planner already takes the corner as fast as
+    // it could follow an arc of radius junction_deviation*cos(turn/2)/(1 - cos(turn/2)).
+    float cos_half = sqrtf(0.5f * (1.0f + cos_turn));
+    float sin_half = sqrtf(0.5f * (1.0f - cos_turn));
+    float trim     = MIN(blend.pl_data.path_tolerance * sin_half / (1.0f - cos_half), MIN(blend.max_trim, max_trim));
+    float radius   = trim * cos_half / sin_half;
+    if (radius <= config->_junctionDeviation * cos_half / (1.0f - cos_half)) {
+        return false;
+    }
+
+    float arc_start[MAX_N_AXIS];
+    float normal[MAX_N_AXIS];  // Unit vector in the plane of the turn, perpendicular to the held move
+    float sin_turn = 2.0f * sin_half * cos_half;
+    for (size_t i = 0; i < n_axis; i++) {
+        arc_start[i] = blend.end[i] - trim * blend.unit_vec[i];
+        normal[i]    = (unit_vec[i] - cos_turn * blend.unit_vec[i]) / sin_turn;
+    }
+    mc_blend_send(arc_start, blend.start);
+
+    // Same chord tolerance as mc_arc()
+    float    turn      = 2.0f * atan2f(sin_half, cos_half);
+    float    tolerance = config->_arcTolerance;
+    uint16_t segments  = 1;
+    if (2.0f * radius > tolerance) {
+        segments = MAX(1, uint16_t(floorf(0.5f * turn * radius / sqrtf(tolerance * (2.0f * radius - tolerance)))));
+    }
+    float previous[MAX_N_AXIS];
+    copyAxes(previous, arc_start);
+    for (uint16_t segment = 1; segment <= segments; segment++) {
+        float angle  = turn * segment / segments;
+        float along  = radius * sinf(angle);
+        float across = radius * (1.0f - cosf(angle));
+        for (size_t i = 0; i < n_axis; i++) {
+            arc_end[i] = arc_start[i] + along * blend.unit_vec[i] + across * normal[i];
+        }
+        mc_blend_send(arc_end, previous);
+        copyAxes(previous, arc_end);
+    }
+    return true;
+}
+
+// Holds a feed move in continuous mode, first sending the previously held move with any blend
+// between the two.
+static bool mc_blend_line(float* target, plan_line_data_t* pl_data, float* position) {
+    auto  n_axis = config->_axes->_numberAxis;
+    float unit_vec[MAX_N_AXIS];
+    for (size_t i = 0; i < n_axis; i++) {
+        unit_vec[i] = target[i] - position[i];
+    }
+    float length = vector_length(unit_vec, n_axis);
+    if (length == 0.0f) {
+        return true;  // The planner ignores empty moves.
+    }
+    scale_vector(unit_vec, 1.0f / length, n_axis);
+
+    float start[MAX_N_AXIS];
+    copyAxes(start, position);
+    if (blend.pending) {
+        // Each blend may use up to half of a move, leaving the other half for the blend at its other end.
+        if (!mc_blend_corner(unit_vec, 0.5f * length, start)) {
+            mc_blend_send(blend.end, blend.start);
+        }
+    }
+    copyAxes(blend.start, start);
+    copyAxes(blend.end, target);
+    copyAxes(blend.unit_vec, unit_vec);
+    blend.max_trim = 0.5f * length;
+    blend.pl_data  = *pl_data;
+    blend.pending  = true;
+    return true;
+}
+
 bool mc_linear(float* target, plan_line_data_t* pl_data, float* position) {
     if (!pl_data->is_jog && !pl_data->limits_checked) {  // soft limits for jogs have already been dealt with
         if (config->_kinematics->invalid_line(target)) {
             return false;
         }
     }
+    if (mc_blendable(pl_data)) {
+        return mc_blend_line(target, pl_data, position);
+    }
+    mc_flush_blend();
     return mc_linear_no_check(target, pl_data, position);
 }
 
+// Sends an arc to the planner as a single block. Like mc_move_motors(), but never a jog.
+static bool mc_move_arc(float* target, plan_line_data_t* pl_data, const plan_arc_t* arc) {
+    if (sys.state == State::CheckMode) {
+        return false;
+    }
+    while (plan_check_full_buffer()) {
+        protocol_auto_cycle_start();
+        protocol_execute_realtime();
+        if (sys.abort) {
+            return false;
+        }
+    }
+    return plan_buffer_arc(target, pl_data, arc);
+}
+
+uint16_t mc_arc_segments(float radius, float angular_travel) {
+    static float    last_radius         = 0.0f;
+    static float    last_angular_travel = 0.0f;
+    static float    last_tolerance      = 0.0f;
+    static uint16_t last_segments       = 0;
+
+    float tolerance = config->_arcTolerance;
+    if (radius != last_radius || angular_travel != last_angular_travel || tolerance != last_tolerance) {
+        // NOTE: Segment end points are on the arc, which can lead to the arc diameter being smaller by up to
+        // (2x) arc_tolerance. For 99% of users, this is just fine. If a different arc segment fit
+        // is desired, i.e. least-squares, midpoint on arc, just change the mm_per_arc_segment calculation.
+        // For most uses, this value should not exceed 2000.
+        last_segments = uint16_t(floorf(fabsf(0.5 * angular_travel * radius) / sqrtf(tolerance * (2 * radius - tolerance))));
+
+        last_radius         = radius;
+        last_angular_travel = angular_travel;
+        last_tolerance      = tolerance;
+    }
+    return last_segments;
+}
+
+/* Vector rotation by transformation matrix: r is the original vector, r_T is the rotated vector,
+   and phi is the angle of rotation. Solution approach by Jens Geisler.
+       r_T = [cos(phi) -sin(phi);
+              sin(phi)  cos(phi] * r ;
+
+   For arc generation, the center of the circle is the axis of rotation and the radius vector is
+   defined from the circle center to the initial position. Each line segment is formed by successive
+   vector rotations. Single precision values can accumulate error greater than tool precision in rare
+   cases. So, exact arc path correction is implemented every N_ARC_CORRECTION segments.
+
+   The rotation increments cos(phi) and sin(phi) are exact, from one sincosf() call per arc. Pocketing
+   and engraving code repeats the same angle per segment many times, so the increments of the last arc
+   are kept and reused when the angle matches, which leaves only the corrections to use trig functions.
+*/
+ArcRotation::Increment ArcRotation::increment(float theta_per_segment) {
+    static float     last_theta = 0.0f;
+    static Increment last       = { 1.0f, 0.0f };
+
+    if (theta_per_segment != last_theta) {
+        sincosf(theta_per_segment, &last.sin_T, &last.cos_T);
+        last_theta = theta_per_segment;
+    }
+    return last;
+}
+
+// Caps the number of chords of an arc so that each chord lasts at least one step segment, since the
+// segment generator cannot execute a block in less. When the planner buffer is running low, the chords
+// are also made long enough that its free blocks can hold the time needed to stop from the feed rate,
+// so that the planner does not have to slow down. The chord error never exceeds arc_tolerance_scale
+// times arc_tolerance_mm, and grows with the square of the chord length.
+static uint16_t mc_arc_segment_limit(plan_line_data_t* pl_data, float millimeters, size_t axis_0, size_t axis_1, uint16_t segments) {
+    if (pl_data->motion.rapidMotion || pl_data->feed_rate <= 0.0f) {
+        return segments;
+    }
+    float arc_time  = pl_data->motion.inverseTime ? 1.0f / pl_data->feed_rate : millimeters / pl_data->feed_rate;  // min
+    float min_count = segments / sqrtf(config->_arcToleranceScale);
+
+    float limit = arc_time / DT_SEGMENT;
+    if (limit > min_count) {
+        float plane[MAX_N_AXIS] = {};
+        plane[axis_0] = plane[axis_1] = 1.0f;
+        float acceleration        = limit_acceleration_by_axis_maximum(plane);  // Of the slower axis
+        float shortfall           = millimeters / arc_time / acceleration - plan_get_buffered_time();
+        if (shortfall > 0.0f) {
+            limit = MIN(limit, arc_time * MAX(plan_get_block_buffer_available(), 1) / shortfall);
+        }
+    }
+    limit = MAX(limit, min_count);
+    return limit < segments ? uint16_t(limit) : segments;
+}
+
+// An arc planned as one block is held to the axis rate limits of the slowest direction that its
+// tangent takes, where each chord would get the limit of its own direction. So only plan an arc as
+// one block when its feed rate is within the rate limit of every axis that it moves.
+static bool mc_arc_within_rate_limit(
+    plan_line_data_t* pl_data, float* position, float* target, float radius, float angular_travel, size_t axis_0, size_t axis_1) {
+    auto  n_axis             = config->_axes->_numberAxis;
+    float moving[MAX_N_AXIS] = {};
+    float travel_sqr         = angular_travel * radius * angular_travel * radius;
+    for (size_t i = 0; i < n_axis; i++) {
+        if (i == axis_0 || i == axis_1) {
+            moving[i] = 1.0f;
+        } else if (target[i] != position[i]) {
+            moving[i] = 1.0f;
+            travel_sqr += (target[i] - position[i]) * (target[i] - position[i]);
+        }
+    }
+    float rate = pl_data->motion.inverseTime ? pl_data->feed_rate * sqrtf(travel_sqr) : pl_data->feed_rate;
+    return rate <= limit_rate_by_axis_maximum(moving);  // Of the slowest axis
+}
+
 // Execute an arc in offset mode format. position == current xyz, target == target xyz,
 // offset == offset from current xyz, axis_X defines circle plane in tool space, axis_linear is
 // the direction of helical travel, radius == circle radius, isclockwise boolean. Used
@@ -173,12 +403,30 @@ void mc_arc(float*            target,
         }
     }
 
-    // NOTE: Segment end points are on the arc, which can lead to the arc diameter being smaller by up to
-    // (2x) arc_tolerance. For 99% of users, this is just fine. If a different arc segment fit
-    // is desired, i.e. least-squares, midpoint on arc, just change the mm_per_arc_segment calculation.
-    // For most uses, this value should not exceed 2000.
-    uint16_t segments =
-        uint16_t(floorf(fabsf(0.5 * angular_travel * radius) / sqrtf(config->_arcTolerance * (2 * radius - config->_arcTolerance))));
+    uint16_t segments = mc_arc_segments(radius, angular_travel);
+    if (segments > 1 && config->_kinematics->canPlanArcs() &&
+        mc_arc_within_rate_limit(pl_data, position, target, radius, angular_travel, axis_0, axis_1)) {
+        // The segment generator follows the arc itself, so the planner needs only one block.
+        plan_arc_t arc;
+        arc.center[0]      = center[0];
+        arc.center[1]      = center[1];
+        arc.radius[0]      = radii[0];
+        arc.radius[1]      = radii[1];
+        arc.angular_travel = angular_travel;
+        arc.axis_0         = axis_0;
+        arc.axis_1         = axis_1;
+        for (size_t i = 0; i < n_axis; i++) {
+            arc.start[i] = position[i];
+            arc.delta[i] = (i == axis_0 || i == axis_1) ? 0.0f : target[i] - position[i];
+        }
+        mc_flush_blend();
+        mc_move_arc(target, pl_data, &arc);
+        return;
+    }
+    if (segments) {
+        float millimeters = hypot_f(angular_travel * radius, target[axis_linear] - position[axis_linear]);
+        segments          = mc_arc_segment_limit(pl_data, millimeters, axis_0, axis_1, segments);
+    }
     if (segments) {
         // Multiply inverse feed_rate to compensate for the fact that this movement is approximated
         // by a number of discrete segments. The inverse feed_rate should be correct for the sum of
@@ -193,56 +441,10 @@ void mc_arc(float*            target,
         for (size_t i = A_AXIS; i < n_axis; i++) {
             linear_per_segment[i] = (target[i] - position[i]) / segments;
         }
-        /* Vector rotation by transformation matrix: r is the original vector, r_T is the rotated vector,
-           and phi is the angle of rotation. Solution approach by Jens Geisler.
-               r_T = [cos(phi) -sin(phi);
-                      sin(phi)  cos(phi] * r ;
-
-           For arc generation, the center of the circle is the axis of rotation and the radius vector is
-           defined from the circle center to the initial position. Each line segment is formed by successive
-           vector rotations. Single precision values can accumulate error greater than tool precision in rare
-           cases. So, exact arc path correction is implemented. This approach avoids the problem of too many very
-           expensive trig operations [sin(),cos(),tan()] which can take 100-200 usec each to compute.
-
-           Small angle approximation may be used to reduce computation overhead further. A third-order approximation
-           (second order sin() has too much error) holds for most, if not, all CNC applications. Note that this
-           approximation will begin to accumulate a numerical drift error when theta_per_segment is greater than
-           ~0.25 rad(14 deg) AND the approximation is successively used without correction several dozen times. This
-           scenario is extremely unlikely, since segment lengths and theta_per_segment are automatically generated
-           and scaled by the arc tolerance setting. Only a very large arc tolerance setting, unrealistic for CNC
-           applications, would cause this numerical drift error. However, it is best to set N_ARC_CORRECTION from a
-           low of ~4 to a high of ~20 or so to avoid trig operations while keeping arc generation accurate.
-
-           This approximation also allows mc_arc to immediately insert a line segment into the planner
-           without the initial overhead of computing cos() or sin(). By the time the arc needs to be applied
-           a correction, the planner should have caught up to the lag caused by the initial mc_arc overhead.
-           This is important when there are successive arc motions.
-        */
-        // Computes: cos_T = 1 - theta_per_segment^2/2, sin_T = theta_per_segment - theta_per_segment^3/6) in ~52usec
-        float cos_T = 2.0f - theta_per_segment * theta_per_segment;
-        float sin_T = theta_per_segment * 0.16666667f * (cos_T + 4.0f);
-        cos_T *= 0.5;
-        float    sin_Ti;
-        float    cos_Ti;
-        uint16_t i;
-        size_t   count             = 0;
-        float    original_feedrate = pl_data->feed_rate;  // Kinematics may alter the feedrate, so save an original copy
-        for (i = 1; i < segments; i++) {                  // Increment (segments-1).
-            if (count < N_ARC_CORRECTION) {
-                // Apply vector rotation matrix. ~40 usec
-                float ri = radii[0] * sin_T + radii[1] * cos_T;
-                radii[0] = radii[0] * cos_T - radii[1] * sin_T;
-                radii[1] = ri;
-                count++;
-            } else {
-                // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments. ~375 usec
-                // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
-                cos_Ti   = cosf(i * theta_per_segment);
-                sin_Ti   = sinf(i * theta_per_segment);
-                radii[0] = -offset[axis_0] * cos_Ti + offset[axis_1] * sin_Ti;
-                radii[1] = -offset[axis_0] * sin_Ti - offset[axis_1] * cos_Ti;
-                count    = 0;
-            }
+        ArcRotation rotation(radii, theta_per_segment);
+        float       original_feedrate = pl_data->feed_rate;  // Kinematics may alter the feedrate, so save an original copy
+        for (uint16_t i = 1; i < segments; i++) {            // Increment (segments-1).
+            rotation.step(i, radii);
             // Update arc_target location
             position[axis_0] = center[0] + radii[0];
             position[axis_1] = center[1] + radii[1];
@@ -309,6 +511,9 @@ GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away,
         return GCUpdatePos::None;  // Nothing else to do but bail.
     }
     // Setup and queue probing motion. Auto cycle-start should not start the cycle.
+    // The probe move is never blended, as the planner must hold it when monitoring starts.
+    mc_flush_blend();
+    pl_data->path_tolerance = 0.0f;
     mc_linear(target, pl_data, gc_state.position);
     // Activate the probing state monitor in the stepper module.
     probeState = ProbeState::Active;
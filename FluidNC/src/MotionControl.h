@@ -11,6 +11,7 @@
 #include "Probe.h"
 
 #include <cstdint>
+#include <cmath>
 
 extern volatile ProbeState probeState;  // Probing state value.  Used to coordinate the probing cycle with stepper ISR.
 
@@ -22,6 +23,9 @@ const int PARKING_MOTION_LINE_NUMBER = 0;
 // Execute a linear motion in cartesian space.
 bool mc_linear(float* target, plan_line_data_t* pl_data, float* position);
 
+// Send the feed move held back for path blending in continuous mode (G64), if any.
+void mc_flush_blend();
+
 // Execute a linear motion in motor space.
 bool mc_move_motors(float* target, plan_line_data_t* pl_data);  // returns true if line was submitted to planner
 
@@ -40,6 +44,54 @@ void mc_arc(float*            target,
             bool              is_clockwise_arc,
             int               pword_rotations);
 
+// Number of chords that follow an arc within arc_tolerance_mm. The result for the last radius and
+// angle is cached, since pocketing and engraving code repeats the same arc many times.
+uint16_t mc_arc_segments(float radius, float angular_travel);
+
+// Steps a radius vector around the center of an arc by a fixed angle per chord. The rotation is
+// applied incrementally, with an exact correction every N_ARC_CORRECTION chords to stop drift.
+class ArcRotation {
+    struct Increment {
+        float cos_T;
+        float sin_T;
+    };
+
+    // Returns the rotation increment for an angle, reusing that of the last arc when the angle matches
+    static Increment increment(float theta_per_segment);
+
+    float    _start[2];
+    float    _theta;
+    float    _cos_T;
+    float    _sin_T;
+    uint16_t _count = 0;
+
+public:
+    ArcRotation(const float* radii, float theta_per_segment) : _start { radii[0], radii[1] }, _theta(theta_per_segment) {
+        Increment inc = increment(theta_per_segment);
+        _cos_T        = inc.cos_T;
+        _sin_T        = inc.sin_T;
+    }
+
+    // Rotates radii, which holds the vector of chord i-1, to the end of chord i.
+    void step(uint16_t i, float* radii) {
+        if (_count < N_ARC_CORRECTION) {
+            // Apply vector rotation matrix.
+            float ri = radii[0] * _sin_T + radii[1] * _cos_T;
+            radii[0] = radii[0] * _cos_T - radii[1] * _sin_T;
+            radii[1] = ri;
+            _count++;
+        } else {
+            // Arc correction to radius vector. Compute exact location by applying transformation matrix
+            // from initial radius vector.
+            float sin_Ti, cos_Ti;
+            sincosf(i * _theta, &sin_Ti, &cos_Ti);
+            radii[0] = _start[0] * cos_Ti - _start[1] * sin_Ti;
+            radii[1] = _start[0] * sin_Ti + _start[1] * cos_Ti;
+            _count   = 0;
+        }
+    }
+};
+
 // Dwell for a specific number of seconds
 bool mc_dwell(int32_t milliseconds);
 
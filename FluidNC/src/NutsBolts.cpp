@@ -173,6 +173,24 @@ float limit_acceleration_by_axis_maximum(float* unit_vec) {
     return limit_value * secPerMinSq;
 }
 
+const float secPerMinCu = 60.0 * 60.0 * 60.0;  // Seconds Per Minute Cubed, for jerk conversion
+
+// Returns 0 if none of the axes in the move have a jerk limit.
+float limit_jerk_by_axis_maximum(float* unit_vec) {
+    float limit_value = SOME_LARGE_VALUE;
+    auto  n_axis      = config->_axes->_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        auto axisSetting = config->_axes->_axis[idx];
+        if (unit_vec[idx] != 0 && axisSetting->_jerk != 0) {  // Avoid divide by zero.
+            limit_value = MIN(limit_value, fabsf(axisSetting->_jerk / unit_vec[idx]));
+        }
+    }
+    if (limit_value == SOME_LARGE_VALUE) {
+        return 0.0f;
+    }
+    return limit_value * secPerMinCu;
+}
+
 float limit_rate_by_axis_maximum(float* unit_vec) {
     float limit_value = SOME_LARGE_VALUE;
     auto  n_axis      = config->_axes->_numberAxis;
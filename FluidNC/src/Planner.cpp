@@ -10,21 +10,72 @@
 
 #include "Planner.h"
 #include "Machine/MachineConfig.h"
+#include "Protocol.h"
+#include "SpscRing.h"
+#include "Stepper.h"
 
 #include <cstdlib>  // PSoc Required for labs
 #include <cmath>
 
-static plan_block_t* block_buffer = nullptr;  // A ring buffer for motion instructions
-static uint8_t       block_buffer_tail;       // Index of the block to process now
-static uint8_t       block_buffer_head;       // Index of the next block to be pushed
-static uint8_t       next_buffer_head;        // Index of the next buffer head
-static uint8_t       block_buffer_planned;    // Index of the optimally planned block
+// A ring buffer for motion instructions. The front block is the one being executed and the back
+// block is the one being planned, or a system motion.
+static SpscRing<plan_block_t> block_buffer;
+static plan_arc_t*            arc_buffer = nullptr;  // Arc geometry of the blocks, indexed like block_buffer
+
+struct plan_limit_t {
+    float max_entry_speed_sqr;  // Maximum allowable entry speed based on the minimum of junction limit and
+    //   neighboring nominal speeds with overrides in (mm/min)^2
+    float decel_limit_sqr;  // max_entry_speed_sqr + ramp_offset_sqr in (mm/min)^2
+};
+
+// The entry limits of the buffered blocks, which overrides change, and the queue of the block positions
+// whose deceleration limits can still bound the exit speed of the executing block, in buffer order with
+// strictly increasing limits. See planner_recalculate(). The queue never holds more entries than
+// block_buffer, so both use the same storage indices.
+struct plan_limits_t {
+    plan_limit_t* limit = nullptr;
+    uint32_t*     queue = nullptr;
+    uint32_t      tail;  // Position of the queued block with the lowest limit
+    uint32_t      head;  // Position of the next entry to be pushed
+
+    plan_limit_t& at(uint32_t position) { return limit[block_buffer.index(position)]; }
+    uint32_t&     queue_at(uint32_t position) { return queue[block_buffer.index(position)]; }
+
+    // Adds a block to the end of the queue, first dropping the queued blocks that it makes redundant.
+    void push(uint32_t position) {
+        float limit_sqr = at(position).decel_limit_sqr;
+        while (head != tail) {
+            if (at(queue_at(head - 1)).decel_limit_sqr < limit_sqr) {
+                break;
+            }
+            head--;
+        }
+        queue_at(head++) = position;
+    }
+};
+
+// The limits in use, and a spare set that plan_update_velocity_profile_parameters() fills and swaps in.
+static plan_limits_t  limit_sets[2];
+static plan_limits_t* limits       = &limit_sets[0];
+static plan_limits_t* spare_limits = &limit_sets[1];
+
+// Sum of nominal_time over the buffered blocks. See plan_get_buffered_time().
+static float buffered_time = 0.0f;
 
 void plan_init() {
-    if (block_buffer) {
-        delete[] block_buffer;
+    if (arc_buffer) {
+        delete[] arc_buffer;
+        for (auto& set : limit_sets) {
+            delete[] set.limit;
+            delete[] set.queue;
+        }
+    }
+    block_buffer.init(config->_planner_blocks - 1);
+    arc_buffer = new plan_arc_t[block_buffer.slots()];
+    for (auto& set : limit_sets) {
+        set.limit = new plan_limit_t[block_buffer.slots()];
+        set.queue = new uint32_t[block_buffer.slots()];
     }
-    block_buffer = new plan_block_t[config->_planner_blocks];
 }
 
 // Define planner variables
@@ -34,27 +85,10 @@ typedef struct {
     // i.e. arcs, canned cycles, and backlash compensation.
     float previous_unit_vec[MAX_N_AXIS];  // Unit vector of previous path line segment
     float previous_nominal_speed;         // Nominal speed of previous path line segment
+    float ramp_end_sqr;                   // ramp_offset_sqr of the next block to be pushed
 } planner_t;
 static planner_t pl;
 
-// Returns the index of the next block in the ring buffer. Also called by stepper segment buffer.
-static uint8_t plan_next_block_index(uint8_t block_index) {
-    block_index++;
-    if (block_index == config->_planner_blocks) {
-        block_index = 0;
-    }
-    return block_index;
-}
-
-// Returns the index of the previous block in the ring buffer
-static uint8_t plan_prev_block_index(uint8_t block_index) {
-    if (block_index == 0) {
-        block_index = config->_planner_blocks;
-    }
-    block_index--;
-    return block_index;
-}
-
 /*                            PLANNER SPEED DEFINITION
                                      +--------+   <- current->nominal_speed
                                     /          \
@@ -63,49 +97,55 @@ static uint8_t plan_prev_block_index(uint8_t block_index) {
                                    +-------------+
                                        time -->
 
-  Recalculates the motion plan according to the following basic guidelines:
+  The motion plan follows these basic guidelines:
 
-    1. Go over every feasible block sequentially in reverse order and calculate the junction speeds
-        (i.e. current->entry_speed) such that:
+    1. Going over every feasible block in reverse order, a junction speed (i.e. current->entry_speed)
+       is limited such that:
       a. No junction speed exceeds the pre-computed maximum junction speed limit or nominal speeds of
          neighboring blocks.
       b. A block entry speed cannot exceed one reverse-computed from its exit speed (next->entry_speed)
          with a maximum allowable deceleration over the block travel distance.
       c. The last (or newest appended) block is planned from a complete stop (an exit speed of zero).
-    2. Go over every block in chronological (forward) order and dial down junction speed values if
+    2. Going over every block in chronological (forward) order, junction speed values are dialed down if
       a. The exit speed exceeds the one forward-computed from its entry speed with the maximum allowable
          acceleration over the block travel distance.
 
   When these stages are complete, the planner will have maximized the velocity profiles throughout the all
   of the planner blocks, where every block is operating at its maximum allowable acceleration limits. In
   other words, for all of the blocks in the planner, the plan is optimal and no further speed improvements
-  are possible. If a new block is added to the buffer, the plan is recomputed according to the said
-  guidelines for a new optimal plan.
-
-  To increase computational efficiency of these guidelines, a set of planner block pointers have been
-  created to indicate stop-compute points for when the planner guidelines cannot logically make any further
-  changes or improvements to the plan when in normal operation and new blocks are streamed and added to the
-  planner buffer. For example, if a subset of sequential blocks in the planner have been planned and are
-  bracketed by junction velocities at their maximums (or by the first planner block as well), no new block
-  added to the planner buffer will alter the velocity profiles within them. So we no longer have to compute
-  them. Or, if a set of sequential blocks from the first block in the planner (or a optimal stop-compute
-  point) are all accelerating, they are all optimal and can not be altered by a new block added to the
-  planner buffer, as this will only further increase the plan speed to chronological blocks until a maximum
-  junction velocity is reached. However, if the operational conditions of the plan changes from infrequently
-  used feed holds or feedrate overrides, the stop-compute pointers will be reset and the entire plan is
-  recomputed as stated in the general guidelines.
-
-  Planner buffer index mapping:
-  - block_buffer_tail: Points to the beginning of the planner buffer. First to be executed or being executed.
-  - block_buffer_head: Points to the buffer block after the last block in the buffer. Used to indicate whether
-      the buffer is full or empty. As described for standard ring buffers, this block is always empty.
-  - next_buffer_head: Points to next planner buffer block after the buffer head block. When equal to the
-      buffer tail, this indicates the buffer is full.
-  - block_buffer_planned: Points to the first buffer block after the last optimally planned block for normal
-      streaming operating conditions. Use for planning optimizations by avoiding recomputing parts of the
-      planner buffer that don't change with the addition of a new block, as describe above. In addition,
-      this block can never be less than block_buffer_tail and will always be pushed forward and maintain
-      this requirement when encountered by the plan_discard_current_block() routine during a cycle.
+  are possible.
+
+  Walking the buffer in both directions for every new block makes the cost of each block grow with the
+  size of the buffer. That is needless, because the only junction speed that is ever used is the exit
+  speed of the block that the stepper is executing, so the plan is evaluated lazily, for that junction
+  only, by plan_get_exec_block_exit_speed_sqr():
+
+  - The forward pass (2) reduces to one step from the executing block's entry speed.
+  - The reverse pass (1) has a closed form. Let ramp_offset_sqr be the sum of 2*acceleration*millimeters
+    over the buffered blocks ahead of a block, and cache with each block its deceleration limit
+    decel_limit_sqr = max_entry_speed_sqr + ramp_offset_sqr. Unrolling 1b, the reverse-planned entry
+    speed of block i is
+
+        min(decel_limit_sqr of blocks i..newest, ramp_offset_sqr past the newest block) - ramp_offset_sqr(i)
+
+    because decelerating to block k's limit, or to a stop at the end of the buffer, costs the distance
+    in between.
+
+  The minimum over the blocks after the executing one is kept in the limit queue, a monotonic queue. A new
+  block removes the queued blocks whose limits are not below its own, since the new block caps everything
+  before it at least as hard, so planning a block costs amortized constant time and nothing that a new
+  block cannot change is ever revisited. A feedrate override changes the limits of all the blocks, so
+  plan_update_velocity_profile_parameters() rebuilds the queue. When the exit speed of the executing
+  block changes, the stepper is notified to recompute its profile.
+
+  The ramp offsets increase with every block, so they are periodically rebased onto the executing block
+  to keep their float precision from degrading over a long job.
+
+  The planner runs in the protocol loop, and the segment generator in the motion task, which only pops
+  blocks and plans the exit speed of the executing one. Stepper::Lock is held only for the work that they
+  share, adding a block and popping one, which takes amortized constant time. The planner alone writes
+  the ramp offsets, so a feedrate override computes the new limits and queue into a spare set without
+  the lock, and then swaps it in.
 
   NOTE: Since the planner only computes on what's in the planner buffer, some motions with lots of short
   line segments, like G2/3 arcs or complex curves, may seem to move slow. This is because there simply isn't
@@ -114,130 +154,148 @@ static uint8_t plan_prev_block_index(uint8_t block_index) {
   becomes an annoyance, there are a few simple solutions: (1) Maximize the machine acceleration. The planner
   will be able to compute higher velocity profiles within the same combined distance. (2) Maximize line
   motion(s) distance per block to a desired tolerance. The more combined distance the planner has to use,
-  the faster it can go. (3) Maximize the planner buffer size. This also will increase the combined distance
-  for the planner to compute over. It also increases the number of computations the planner has to perform
-  to compute an optimal plan, so select carefully. The Arduino 328p memory is already maxed out, but future
-  ARM versions should have enough memory and speed for look-ahead blocks numbering up to a hundred or more.
+  the faster it can go. (3) Maximize the planner buffer size. Since the cost of planning a block does not
+  depend on the buffer size, this only costs memory.
 
 */
-static void planner_recalculate() {
-    // Initialize block index to the last block in the planner buffer.
-    uint8_t block_index = plan_prev_block_index(block_buffer_head);
-    // Bail. Can't do anything with one only one plan-able block.
-    if (block_index == block_buffer_planned) {
+
+// Returns the reverse-planned entry speed of the block after the executing block, i.e. the fastest
+// that the executing block can exit and still stop by the end of the buffer.
+static float plan_exec_exit_limit_sqr() {
+    if (block_buffer.count() < 2) {
+        return 0.0f;
+    }
+    // Decelerate to a stop at the end of the buffer, or to the lowest limit ahead if that is lower.
+    // The ramp offsets are subtracted first so that a block's own limit is exact.
+    uint32_t      tail      = block_buffer.tail();
+    plan_block_t* next      = &block_buffer.at(tail + 1);
+    float         limit_sqr = pl.ramp_end_sqr - next->ramp_offset_sqr;
+    if (limits->tail != limits->head) {
+        uint32_t position   = limits->queue_at(limits->tail);
+        float    offset_sqr = block_buffer.at(position).ramp_offset_sqr - next->ramp_offset_sqr;
+        limit_sqr           = MIN(limit_sqr, limits->at(position).max_entry_speed_sqr + offset_sqr);
+    }
+    return MIN(limit_sqr, limits->at(tail + 1).max_entry_speed_sqr);
+}
+
+// Subtracts the ramp offset of the executing block from all of the buffered ramp offsets, once it has
+// grown past the length of the ramp in the buffer. This happens about once per buffer length of blocks.
+static void plan_rebase_ramp() {
+    float base_sqr = block_buffer.at(block_buffer.tail()).ramp_offset_sqr;
+    if (base_sqr <= pl.ramp_end_sqr - base_sqr) {
         return;
     }
-    // Reverse Pass: Coarsely maximize all possible deceleration curves back-planning from the last
-    // block in buffer. Cease planning when the last optimal planned or tail pointer is reached.
-    // NOTE: Forward pass will later refine and correct the reverse pass to create an optimal plan.
-    float         entry_speed_sqr;
-    plan_block_t* next;
-    plan_block_t* current = &block_buffer[block_index];
-    // Calculate maximum entry speed for last block in buffer, where the exit speed is always zero.
-    current->entry_speed_sqr = MIN(current->max_entry_speed_sqr, 2 * current->acceleration * current->millimeters);
-    block_index              = plan_prev_block_index(block_index);
-    if (block_index == block_buffer_planned) {  // Only two plannable blocks in buffer. Reverse pass complete.
-        // Check if the first block is the tail. If so, notify stepper to update its current parameters.
-        if (block_index == block_buffer_tail) {
-            Stepper::update_plan_block_parameters();
+    for (uint32_t position = block_buffer.tail(); position != block_buffer.head(); position++) {
+        block_buffer.at(position).ramp_offset_sqr -= base_sqr;
+        limits->at(position).decel_limit_sqr -= base_sqr;
+    }
+    pl.ramp_end_sqr -= base_sqr;
+}
+
+// Adds the newest block to the plan. Called with the block at the buffer head, before the head is advanced.
+static void planner_recalculate(plan_block_t* block, float max_entry_speed_sqr) {
+    {
+        Stepper::Lock lock;
+
+        float old_limit_sqr = plan_exec_exit_limit_sqr();
+
+        if (block_buffer.empty()) {
+            // The block will execute next. Start a new ramp with it, and keep it out of the queue.
+            pl.ramp_end_sqr = 0.0f;
+        } else {
+            plan_rebase_ramp();
         }
-    } else {  // Three or more plan-able blocks
-        while (block_index != block_buffer_planned) {
-            next        = current;
-            current     = &block_buffer[block_index];
-            block_index = plan_prev_block_index(block_index);
-            // Check if next block is the tail block(=planned block). If so, update current stepper parameters.
-            if (block_index == block_buffer_tail) {
-                Stepper::update_plan_block_parameters();
-            }
-            // Compute maximum entry speed decelerating over the current block from its exit speed.
-            if (current->entry_speed_sqr != current->max_entry_speed_sqr) {
-                entry_speed_sqr = next->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
-                if (entry_speed_sqr < current->max_entry_speed_sqr) {
-                    current->entry_speed_sqr = entry_speed_sqr;
-                } else {
-                    current->entry_speed_sqr = current->max_entry_speed_sqr;
-                }
-            }
+        uint32_t      position    = block_buffer.head();
+        plan_limit_t& limit       = limits->at(position);
+        block->ramp_offset_sqr    = pl.ramp_end_sqr;
+        limit.max_entry_speed_sqr = max_entry_speed_sqr;
+        limit.decel_limit_sqr     = max_entry_speed_sqr + block->ramp_offset_sqr;
+
+        pl.ramp_end_sqr += 2 * block->acceleration * block->millimeters;
+        if (!block_buffer.empty()) {
+            limits->push(position);
         }
-    }
-    // Forward Pass: Forward plan the acceleration curve from the planned pointer onward.
-    // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
-    next        = &block_buffer[block_buffer_planned];  // Begin at buffer planned pointer
-    block_index = plan_next_block_index(block_buffer_planned);
-    while (block_index != block_buffer_head) {
-        current = next;
-        next    = &block_buffer[block_index];
-        // Any acceleration detected in the forward pass automatically moves the optimal planned
-        // pointer forward, since everything before this is all optimal. In other words, nothing
-        // can improve the plan from the buffer tail to the planned pointer by logic.
-        if (current->entry_speed_sqr < next->entry_speed_sqr) {
-            entry_speed_sqr = current->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
-            // If true, current block is full-acceleration and we can move the planned pointer forward.
-            if (entry_speed_sqr < next->entry_speed_sqr) {
-                next->entry_speed_sqr = entry_speed_sqr;  // Always <= max_entry_speed_sqr. Backward pass sets this.
-                block_buffer_planned  = block_index;      // Set optimal plan pointer.
+
+        buffered_time += block->nominal_time;
+        block_buffer.push();
+
+        // The new block can only raise the exit speed of the executing block. If the stepper is already
+        // accelerating over the whole block without reaching the old limit, raising it changes nothing.
+        float new_limit_sqr = plan_exec_exit_limit_sqr();
+        if (new_limit_sqr != old_limit_sqr) {
+            plan_block_t* next = &block_buffer.at(block_buffer.tail() + 1);
+            if (next->entry_speed_sqr >= old_limit_sqr) {
+                Stepper::update_plan_block_parameters();
             }
         }
-        // Any block set at its maximum entry speed also creates an optimal plan up to this
-        // point in the buffer. When the plan is bracketed by either the beginning of the
-        // buffer and a maximum entry speed or two maximum entry speeds, every block in between
-        // cannot logically be further improved. Hence, we don't have to recompute them anymore.
-        if (next->entry_speed_sqr == next->max_entry_speed_sqr) {
-            block_buffer_planned = block_index;
-        }
-        block_index = plan_next_block_index(block_index);
     }
+    notify_motion_task();
 }
 
 void plan_reset() {
+    Stepper::Lock lock;
+
     memset(&pl, 0, sizeof(planner_t));  // Clear planner struct
     plan_reset_buffer();
 }
 
 void plan_reset_buffer() {
-    block_buffer_tail    = 0;
-    block_buffer_head    = 0;  // Empty = tail
-    next_buffer_head     = 1;  // plan_next_block_index(block_buffer_head)
-    block_buffer_planned = 0;  // = block_buffer_tail;
+    Stepper::Lock lock;
+
+    block_buffer.clear();
+    buffered_time = 0.0f;
+    limits->tail  = 0;
+    limits->head  = 0;  // Empty = tail
 }
 
 // Called from stepper pulse function when the block is complete
 void plan_discard_current_block() {
-    if (block_buffer_head != block_buffer_tail) {  // Discard non-empty buffer.
-        uint8_t block_index = plan_next_block_index(block_buffer_tail);
-        // Push block_buffer_planned pointer, if encountered.
-        if (block_buffer_tail == block_buffer_planned) {
-            block_buffer_planned = block_index;
+    Stepper::Lock lock;
+
+    if (!block_buffer.empty()) {  // Discard non-empty buffer.
+        buffered_time -= block_buffer.front().nominal_time;
+        block_buffer.pop();
+        // The new executing block no longer bounds its own exit speed.
+        if (limits->tail != limits->head && limits->queue_at(limits->tail) == block_buffer.tail()) {
+            limits->tail++;
+        }
+        if (block_buffer.empty()) {
+            buffered_time = 0.0f;  // Drop the rounding error
         }
-        block_buffer_tail = block_index;
     }
 }
 
 // Returns address of planner buffer block used by system motions. Called by segment generator.
 plan_block_t* plan_get_system_motion_block() {
-    return &block_buffer[block_buffer_head];
+    return &block_buffer.back();
 }
 
 // Returns address of first planner block, if available. Called by various main program functions.
 plan_block_t* plan_get_current_block() {
-    if (block_buffer_head == block_buffer_tail) {
+    if (block_buffer.empty()) {
         return NULL;  // Buffer empty
     }
-    return &block_buffer[block_buffer_tail];
+    return &block_buffer.front();
 }
 
+// Plans the entry speed of the block after the executing block, which is final once the stepper uses it.
 float plan_get_exec_block_exit_speed_sqr() {
-    uint8_t block_index = plan_next_block_index(block_buffer_tail);
-    if (block_index == block_buffer_head) {
+    Stepper::Lock lock;
+
+    if (block_buffer.count() < 2) {
         return 0.0f;
     }
-    return block_buffer[block_index].entry_speed_sqr;
+    plan_block_t* current = &block_buffer.front();
+    plan_block_t* next    = &block_buffer.at(block_buffer.tail() + 1);
+    // Forward pass over the executing block, from its entry or current speed over its remaining distance.
+    float entry_speed_sqr = current->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
+    next->entry_speed_sqr = MIN(plan_exec_exit_limit_sqr(), entry_speed_sqr);
+    return next->entry_speed_sqr;
 }
 
 // Returns the availability status of the block ring buffer. True, if full.
 uint8_t plan_check_full_buffer() {
-    return block_buffer_tail == next_buffer_head;
+    return block_buffer.full();
 }
 
 // Computes and returns block nominal speed based on running condition and override values.
@@ -260,40 +318,56 @@ float plan_compute_profile_nominal_speed(plan_block_t* block) {
     return MINIMUM_FEED_RATE;
 }
 
-// Computes and updates the max entry speed (sqr) of the block, based on the minimum of the junction's
+// Computes and returns the max entry speed (sqr) of the block, based on the minimum of the junction's
 // previous and current nominal speeds and max junction speed.
-static void plan_compute_profile_parameters(plan_block_t* block, float nominal_speed, float prev_nominal_speed) {
+static float plan_compute_profile_parameters(const plan_block_t* block, float nominal_speed, float prev_nominal_speed) {
     // Compute the junction maximum entry based on the minimum of the junction speed and neighboring nominal speeds.
+    float max_entry_speed_sqr;
     if (nominal_speed > prev_nominal_speed) {
-        block->max_entry_speed_sqr = prev_nominal_speed * prev_nominal_speed;
+        max_entry_speed_sqr = prev_nominal_speed * prev_nominal_speed;
     } else {
-        block->max_entry_speed_sqr = nominal_speed * nominal_speed;
+        max_entry_speed_sqr = nominal_speed * nominal_speed;
     }
 
-    if (block->max_entry_speed_sqr > block->max_junction_speed_sqr) {
-        block->max_entry_speed_sqr = block->max_junction_speed_sqr;
+    if (max_entry_speed_sqr > block->max_junction_speed_sqr) {
+        max_entry_speed_sqr = block->max_junction_speed_sqr;
     }
+    return max_entry_speed_sqr;
 }
 
 // Re-calculates buffered motions profile parameters upon a motion-based override change.
+// The blocks that prep pops meanwhile are planned too, and dropped from the queue when it is swapped in.
 void plan_update_velocity_profile_parameters() {
-    uint8_t       block_index = block_buffer_tail;
-    plan_block_t* block;
-    float         nominal_speed;
-    float         prev_nominal_speed = SOME_LARGE_VALUE;  // Set high for first block nominal speed calculation.
-    while (block_index != block_buffer_head) {
-        block         = &block_buffer[block_index];
-        nominal_speed = plan_compute_profile_nominal_speed(block);
-        plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
+    uint32_t tail      = block_buffer.tail();
+    spare_limits->tail = spare_limits->head = tail;
+
+    float prev_nominal_speed = SOME_LARGE_VALUE;  // Set high for first block nominal speed calculation.
+    for (uint32_t position = tail; position != block_buffer.head(); position++) {
+        plan_block_t* block         = &block_buffer.at(position);
+        plan_limit_t& limit         = spare_limits->at(position);
+        float         nominal_speed = plan_compute_profile_nominal_speed(block);
+        limit.max_entry_speed_sqr   = plan_compute_profile_parameters(block, nominal_speed, prev_nominal_speed);
+        limit.decel_limit_sqr       = limit.max_entry_speed_sqr + block->ramp_offset_sqr;
+        if (position != tail) {
+            spare_limits->push(position);
+        }
         prev_nominal_speed = nominal_speed;
-        block_index        = plan_next_block_index(block_index);
     }
     pl.previous_nominal_speed = prev_nominal_speed;  // Update prev nominal speed for next incoming block.
+
+    Stepper::Lock lock;
+    std::swap(limits, spare_limits);
+    tail = block_buffer.tail();
+    while (limits->tail != limits->head && int32_t(limits->queue_at(limits->tail) - tail) <= 0) {
+        limits->tail++;
+    }
 }
 
-bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
+// Prepares the block at the buffer head for a new motion, copying the execution data from pl_data
+// and the start position of the motion to position_steps. Returns nullptr if the motion is not allowed.
+static plan_block_t* plan_start_block(plan_line_data_t* pl_data, int32_t* position_steps) {
     // Prepare and initialize new block. Copy relevant pl_data for block execution.
-    plan_block_t* block = &block_buffer[block_buffer_head];
+    plan_block_t* block = &block_buffer.back();
     memset(block, 0, sizeof(plan_block_t));  // Zero all block values.
     block->motion        = pl_data->motion;
     block->coolant       = pl_data->coolant;
@@ -302,9 +376,6 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     block->line_number   = pl_data->line_number;
     block->is_jog        = pl_data->is_jog;
 
-    // Compute and store initial move distance data.
-    int32_t target_steps[MAX_N_AXIS], position_steps[MAX_N_AXIS];
-    float   unit_vec[MAX_N_AXIS], delta_mm;
     // Copy position data based on type of motion being planned.
     if (block->motion.systemMotion) {
         copyAxes(position_steps, get_motor_steps());
@@ -312,37 +383,17 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
         if (!block->is_jog && Homing::unhomed_axes()) {
             log_info("Unhomed axes: " << config->_axes->maskToNames(Homing::unhomed_axes()));
             send_alarm(ExecAlarm::Unhomed);
-            return false;
+            return nullptr;
         }
         copyAxes(position_steps, pl.position);
     }
-    auto n_axis = config->_axes->_numberAxis;
-    for (size_t idx = 0; idx < n_axis; idx++) {
-        // Calculate target position in absolute steps, number of steps for each axis, and determine max step events.
-        // Also, compute individual axes distance for move and prep unit vector calculations.
-        // NOTE: Computes true distance from converted step values.
-        target_steps[idx]       = mpos_to_steps(target[idx], idx);
-        block->steps[idx]       = labs(target_steps[idx] - position_steps[idx]);
-        block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
-        delta_mm                = steps_to_mpos((target_steps[idx] - position_steps[idx]), idx);
-        unit_vec[idx]           = delta_mm;  // Store unit vector numerator
-        // Set direction bits. Bit enabled always means direction is negative.
-        if (delta_mm < 0.0) {
-            block->direction_bits |= bitnum_to_mask(idx);
-        }
-    }
-    // Bail if this is a zero-length block. Highly unlikely to occur.
-    if (block->step_event_count == 0) {
-        return false;
-    }
+    return block;
+}
 
-    // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
-    // down such that no individual axes maximum values are exceeded with respect to the line direction.
-    // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
-    // if they are also orthogonal/independent. Operates on the absolute value of the unit vector.
-    block->millimeters  = convert_delta_vector_to_unit_vector(unit_vec);
-    block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
-    block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+// Sets the rates and the junction speed of a block whose distance and axis limits are known, and
+// adds it to the plan. entry_vec and exit_vec are the directions of travel at its ends.
+static void plan_finish_block(plan_block_t* block, plan_line_data_t* pl_data, float* entry_vec, float* exit_vec, int32_t* target_steps) {
+    auto n_axis = config->_axes->_numberAxis;
     // Store programmed rate.
     if (block->motion.rapidMotion) {
         block->programmed_rate = block->rapid_rate;
@@ -353,7 +404,7 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
         }
     }
     // TODO: Need to check this method handling zero junction speeds when starting from rest.
-    if ((block_buffer_head == block_buffer_tail) || (block->motion.systemMotion)) {
+    if (block_buffer.empty() || (block->motion.systemMotion)) {
         // Initialize block entry speed as zero. Assume it will be starting from rest. Planner will correct this later.
         // If system motion, the system motion block always is assumed to start from rest and end at a complete stop.
         block->entry_speed_sqr        = 0.0;
@@ -371,10 +422,9 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
         //
         // NOTE: If the junction deviation value is finite, the motions are executed in exact path
         // mode (G61). If the junction deviation value is zero, the motions are executed in exact
-        // stop mode (G61.1) manner. In the future, if continuous mode (G64) is desired, the math here
-        // is exactly the same. Instead of motioning all the way to junction point, the machine will
-        // just follow the arc circle defined here. The Arduino doesn't have the CPU cycles to perform
-        // a continuous mode path, but ARM-based microcontrollers most certainly do.
+        // stop mode (G61.1) manner. Continuous mode (G64) is handled before the planner, by
+        // mc_linear() replacing corners with real arcs inside the path tolerance. The blocks of
+        // those arcs then meet at shallow junctions that this same math lets through quickly.
         //
         // NOTE: The max junction speed is a fixed value, since machine acceleration limits cannot be
         // changed dynamically during operation nor can the line move geometry. This must be kept in
@@ -383,8 +433,8 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
         float junction_unit_vec[MAX_N_AXIS];
         float junction_cos_theta = 0.0;
         for (size_t idx = 0; idx < n_axis; idx++) {
-            junction_cos_theta -= pl.previous_unit_vec[idx] * unit_vec[idx];
-            junction_unit_vec[idx] = unit_vec[idx] - pl.previous_unit_vec[idx];
+            junction_cos_theta -= pl.previous_unit_vec[idx] * entry_vec[idx];
+            junction_unit_vec[idx] = entry_vec[idx] - pl.previous_unit_vec[idx];
         }
         // NOTE: Computed without any expensive trig, sin() or acos(), by trig half angle identity of cos(theta).
         if (junction_cos_theta > 0.999999) {
@@ -406,18 +456,165 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     }
     // Block system motion from updating this data to ensure next g-code motion is computed correctly.
     if (!(block->motion.systemMotion)) {
-        float nominal_speed = plan_compute_profile_nominal_speed(block);
-        plan_compute_profile_parameters(block, nominal_speed, pl.previous_nominal_speed);
+        float nominal_speed       = plan_compute_profile_nominal_speed(block);
+        float max_entry_speed_sqr = plan_compute_profile_parameters(block, nominal_speed, pl.previous_nominal_speed);
         pl.previous_nominal_speed = nominal_speed;
+        block->nominal_time       = block->millimeters / nominal_speed;
         // Update previous path unit_vector and planner position.
-        copyAxes(pl.previous_unit_vec, unit_vec);
+        copyAxes(pl.previous_unit_vec, exit_vec);
         copyAxes(pl.position, target_steps);
-        // New block is all set. Update buffer head and next buffer head indices.
-        block_buffer_head = next_buffer_head;
-        next_buffer_head  = plan_next_block_index(block_buffer_head);
-        // Finish up by recalculating the plan with the new block.
-        planner_recalculate();
+        // New block is all set. Add it to the plan and update buffer head and next buffer head indices.
+        planner_recalculate(block, max_entry_speed_sqr);
+    }
+}
+
+bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
+    // Compute and store initial move distance data.
+    int32_t       target_steps[MAX_N_AXIS], position_steps[MAX_N_AXIS];
+    float         unit_vec[MAX_N_AXIS], delta_mm;
+    plan_block_t* block = plan_start_block(pl_data, position_steps);
+    if (!block) {
+        return false;
     }
+    auto n_axis = config->_axes->_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        // Calculate target position in absolute steps, number of steps for each axis, and determine max step events.
+        // Also, compute individual axes distance for move and prep unit vector calculations.
+        // NOTE: Computes true distance from converted step values.
+        target_steps[idx]       = mpos_to_steps(target[idx], idx);
+        block->steps[idx]       = labs(target_steps[idx] - position_steps[idx]);
+        block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
+        delta_mm                = steps_to_mpos((target_steps[idx] - position_steps[idx]), idx);
+        unit_vec[idx]           = delta_mm;  // Store unit vector numerator
+        // Set direction bits. Bit enabled always means direction is negative.
+        if (delta_mm < 0.0) {
+            block->direction_bits |= bitnum_to_mask(idx);
+        }
+    }
+    // Bail if this is a zero-length block. Highly unlikely to occur.
+    if (block->step_event_count == 0) {
+        return false;
+    }
+
+    // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
+    // down such that no individual axes maximum values are exceeded with respect to the line direction.
+    // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
+    // if they are also orthogonal/independent. Operates on the absolute value of the unit vector.
+    block->millimeters  = convert_delta_vector_to_unit_vector(unit_vec);
+    block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
+    block->jerk         = limit_jerk_by_axis_maximum(unit_vec);
+    block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+    plan_finish_block(block, pl_data, unit_vec, unit_vec, target_steps);
+    return true;
+}
+
+/* Plans an arc as one block, so that a long arc of many short chords costs one planner slot and one
+   junction calculation rather than one for each chord. The segment generator computes the chords as
+   it goes, each as long as a segment but no longer than max_chord. See Stepper::prep_buffer().
+
+   The junction into the arc uses its starting tangent, and the junction out of it its ending tangent.
+   The tangent turns as the arc goes, so the axis limits are applied to the envelope of the tangent
+   over the whole arc. The speed around the arc
+   is limited to the junction speed between chords of the length that mc_arc() would have planned,
+   so that arcs run as fast as they did as lines.
+*/
+bool plan_buffer_arc(float* target, plan_line_data_t* pl_data, const plan_arc_t* arc_data) {
+    int32_t       target_steps[MAX_N_AXIS], position_steps[MAX_N_AXIS];
+    plan_block_t* block = plan_start_block(pl_data, position_steps);
+    if (!block) {
+        return false;
+    }
+    plan_arc_t* arc = &arc_buffer[block_buffer.index(block_buffer.head())];
+    *arc            = *arc_data;
+    auto n_axis     = config->_axes->_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        target_steps[idx]       = mpos_to_steps(target[idx], idx);
+        int32_t delta_steps     = target_steps[idx] - position_steps[idx];
+        block->steps[idx]       = labs(delta_steps);
+        block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
+        if (delta_steps < 0) {
+            block->direction_bits |= bitnum_to_mask(idx);
+        }
+    }
+    copyAxes(arc->start_steps, position_steps);
+    copyAxes(arc->end_steps, target_steps);
+
+    auto  a0     = arc->axis_0;
+    auto  a1     = arc->axis_1;
+    float radius = hypot_f(arc->radius[0], arc->radius[1]);
+    float travel = arc->angular_travel * radius;  // Signed length in the plane
+
+    float envelope[MAX_N_AXIS];
+    copyAxes(envelope, arc->delta);
+    envelope[a1] = 0.0f;
+    envelope[a0] = travel;
+    float length = convert_delta_vector_to_unit_vector(envelope);
+    if (length == 0.0f) {
+        return false;
+    }
+
+    // Rotate the radius vector a quarter turn for the tangents, which are d(position)/d(length).
+    float entry_vec[MAX_N_AXIS], exit_vec[MAX_N_AXIS];
+    float rt[2] = { target[a0] - arc->center[0], target[a1] - arc->center[1] };
+    float scale = arc->angular_travel / length;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        entry_vec[idx] = exit_vec[idx] = arc->delta[idx] / length;
+    }
+    entry_vec[a0] = -arc->radius[1] * scale;
+    entry_vec[a1] = arc->radius[0] * scale;
+    exit_vec[a0]  = -rt[1] * scale;
+    exit_vec[a1]  = rt[0] * scale;
+
+    // The envelope of the tangent is the most that each axis moves per mm anywhere along the arc, like
+    // the unit vector of a line. An axis of the plane moves fastest at the ends of the arc, unless the
+    // tangent swings through the direction of that axis on the way.
+    float plane_rate = envelope[a0];
+    float start      = atan2f(entry_vec[a1], entry_vec[a0]) / float(M_PI);  // In half turns
+    float end        = start + arc->angular_travel / float(M_PI);
+    float low        = MIN(start, end);
+    float high       = MAX(start, end);
+    envelope[a0]     = floorf(high) >= ceilf(low) ? plane_rate : MAX(fabsf(entry_vec[a0]), fabsf(exit_vec[a0]));
+    envelope[a1]     = floorf(high - 0.5f) >= ceilf(low - 0.5f) ? plane_rate : MAX(fabsf(entry_vec[a1]), fabsf(exit_vec[a1]));
+
+    block->arc          = arc;
+    block->millimeters  = arc->millimeters = length;
+    block->acceleration = limit_acceleration_by_axis_maximum(envelope);
+    block->jerk         = limit_jerk_by_axis_maximum(envelope);
+    block->rapid_rate   = limit_rate_by_axis_maximum(envelope);
+
+    // Same segments as mc_arc()
+    float tolerance = config->_arcTolerance;
+    arc->max_chord  = 2.0f * sqrtf(tolerance * (2.0f * radius - tolerance));
+    float segments  = floorf(fabsf(travel) / arc->max_chord);
+    if (segments > 1.0f) {
+        // The chords turn by angular_travel/segments at each junction, and sin(theta/2) of the
+        // planner junction math is the cosine of half of that.
+        float   cos_half = cosf(0.5f * arc->angular_travel / segments);
+        float   unit[MAX_N_AXIS];
+        uint8_t axes[2] = { a0, a1 };
+        float   radial_acceleration = SOME_LARGE_VALUE;
+        for (auto axis : axes) {
+            memset(unit, 0, sizeof(unit));
+            unit[axis]          = 1.0f;
+            radial_acceleration = MIN(radial_acceleration, limit_acceleration_by_axis_maximum(unit));
+        }
+        float speed_sqr = MAX(MINIMUM_JUNCTION_SPEED * MINIMUM_JUNCTION_SPEED,
+                              (radial_acceleration * config->_junctionDeviation * cos_half) / (1.0f - cos_half));
+        block->rapid_rate = MIN(block->rapid_rate, sqrtf(speed_sqr));
+    }
+
+    // Any stretch of the arc this long moves at least one of its axes by a step.
+    float   mm_per_step = 0.0f;
+    uint8_t moving      = 0;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        if (idx == a0 || idx == a1 || arc->delta[idx] != 0.0f) {
+            mm_per_step = MAX(mm_per_step, 1.0f / config->_axes->_axis[idx]->_stepsPerMm);
+            ++moving;
+        }
+    }
+    arc->step_per_mm = 1.0f / (mm_per_step * sqrtf(moving));
+
+    plan_finish_block(block, pl_data, entry_vec, exit_vec, target_steps);
     return true;
 }
 
@@ -433,18 +630,19 @@ void plan_sync_position() {
 // Returns the number of available blocks are in the planner buffer.
 // Called from report_realtime_status
 uint8_t plan_get_block_buffer_available() {
-    if (block_buffer_head >= block_buffer_tail) {
-        return (config->_planner_blocks - 1) - (block_buffer_head - block_buffer_tail);
-    } else {
-        return block_buffer_tail - block_buffer_head - 1;
-    }
+    return block_buffer.available();
+}
+
+// Returns the time that the buffered blocks take at their nominal speeds when they were planned, in
+// minutes. The time spent accelerating, the progress of the executing block and later overrides are
+// not counted, so this is an estimate. Called by mc_arc() to size arc segments.
+float plan_get_buffered_time() {
+    return buffered_time;
 }
 
 // Re-initialize buffer plan with a partially completed block, assumed to exist at the buffer tail.
 // Called after a steppers have come to a complete stop for a feed hold and the cycle is stopped.
 void plan_cycle_reinitialize() {
-    // Re-plan from a complete stop. Reset planner entry speeds and buffer planned pointer.
+    // Re-plan from a complete stop. The rest of the plan does not depend on the executing block.
     Stepper::update_plan_block_parameters();
-    block_buffer_planned = block_buffer_tail;
-    planner_recalculate();
 }
@@ -24,6 +24,25 @@ struct PlMotion {
     uint8_t inverseTime : 1;     // Interprets feed rate value as inverse time when set.
 };
 
+// Geometry of a circular or helical arc that the segment generator follows directly, instead of
+// the arc being broken into lines before it reaches the planner. See plan_buffer_arc().
+struct plan_arc_t {
+    float   center[2];          // Center of the circle in the plane of the arc (mm)
+    float   radius[2];          // Vector from the center to the start of the arc (mm)
+    float   angular_travel;     // Angle swept by the arc, counterclockwise positive (radians)
+    float   start[MAX_N_AXIS];  // Start position (mm)
+    float   delta[MAX_N_AXIS];  // Travel of the axes that are not in the plane of the arc (mm)
+    uint8_t axis_0;             // First axis of the plane of the arc
+    uint8_t axis_1;             // Second axis of the plane of the arc
+
+    // Set by the planner
+    float   millimeters;              // Length of the arc (mm)
+    float   max_chord;                // Longest segment that stays within the arc tolerance (mm)
+    float   step_per_mm;              // Steps per mm along the arc of the slowest stepping direction
+    int32_t start_steps[MAX_N_AXIS];  // Start position (steps)
+    int32_t end_steps[MAX_N_AXIS];    // End position (steps)
+};
+
 // This struct stores a linear movement of a g-code block motion with its critical "nominal" values
 // are as specified in the source g-code.
 struct plan_block_t {
@@ -42,12 +61,17 @@ struct plan_block_t {
 
     // Fields used by the motion planner to manage acceleration. Some of these values may be updated
     // by the stepper module during execution of special motion cases for replanning purposes.
-    float entry_speed_sqr;      // The current planned entry speed at block junction in (mm/min)^2
-    float max_entry_speed_sqr;  // Maximum allowable entry speed based on the minimum of junction limit and
-    //   neighboring nominal speeds with overrides in (mm/min)^2
+    float entry_speed_sqr;  // The current planned entry speed at block junction in (mm/min)^2
+    // NOTE: Only planned for the executing block and the block after it. The maximum entry speeds,
+    // which overrides change, are kept by the planner. See plan_update_velocity_profile_parameters().
     float acceleration;  // Axis-limit adjusted line acceleration in (mm/min^2). Does not change.
+    float jerk;          // Axis-limit adjusted line jerk in (mm/min^3), or 0 for trapezoidal ramps. Does not change.
     float millimeters;   // The remaining distance for this block to be executed in (mm).
     // NOTE: This value may be altered by stepper algorithm during execution.
+    float nominal_time;  // Time of the whole block at its nominal speed when it was planned in (min). Does not change.
+
+    // Cached deceleration data used by the planner to plan a new block without revisiting the others.
+    float ramp_offset_sqr;  // Sum of 2*acceleration*millimeters over the buffered blocks ahead of this one in (mm/min)^2
 
     // Stored rate limiting data used by planner when changes occur.
     float max_junction_speed_sqr;  // Junction entry speed limit based on direction vectors in (mm/min)^2
@@ -58,6 +82,8 @@ struct plan_block_t {
     SpindleSpeed spindle_speed;  // Block spindle speed. Copied from pl_line_data.
 
     bool is_jog;
+
+    plan_arc_t* arc;  // Arc geometry, or nullptr for a line. The steps above are the net steps of an arc.
 };
 
 // Planner data prototype. Must be used when passing new motions to the planner.
@@ -68,6 +94,7 @@ struct plan_line_data_t {
     SpindleState spindle;         // Spindle enable state
     CoolantState coolant;         // Coolant state
     int32_t      line_number;     // Desired line number to report when executing.
+    float        path_tolerance;  // Corner rounding tolerance in mm for G64 continuous mode, or 0 for exact path.
     bool         is_jog;          // true if this was generated due to a jog command
     bool         limits_checked;  // true if soft limits already checked
 };
@@ -84,6 +111,11 @@ void plan_reset_buffer();  // Reset buffer only.
 // Returns true on success.
 bool plan_buffer_line(float* target, plan_line_data_t* pl_data);
 
+// Add a new arc to the buffer as a single block. The geometry fields of arc that are not set by
+// the planner must be filled in, and target must be the end of the arc. Only for kinematics whose
+// motor space is cartesian space. Returns true on success.
+bool plan_buffer_arc(float* target, plan_line_data_t* pl_data, const plan_arc_t* arc);
+
 // Called when the current block is no longer needed. Discards the block and makes the memory
 // availible for new blocks.
 void plan_discard_current_block();
@@ -94,10 +126,8 @@ plan_block_t* plan_get_system_motion_block();
 // Gets the current block. Returns NULL if buffer empty
 plan_block_t* plan_get_current_block();
 
-// Increment block index with wrap-around
-static uint8_t plan_next_block_index(uint8_t block_index);
-
-// Called by step segment buffer when computing executing block velocity profile.
+// Called by step segment buffer when computing executing block velocity profile. Plans the entry
+// speed of the next block.
 float plan_get_exec_block_exit_speed_sqr();
 
 // Called by main program during planner calculations and step segment buffer during initialization.
@@ -118,4 +148,7 @@ uint8_t plan_get_block_buffer_available();
 // Returns the status of the block ring buffer. True, if buffer is full.
 uint8_t plan_check_full_buffer();
 
+// Returns the time that the buffered blocks take at their planned nominal speeds, in minutes.
+float plan_get_buffered_time();
+
 void plan_get_planner_mpos(float* target);
@@ -5,6 +5,7 @@
 
 #include "Machine/MachineConfig.h"
 #include "Configuration/RuntimeSetting.h"
+#include "Configuration/PathIndex.h"
 #include "Configuration/AfterParse.h"
 #include "Configuration/Validator.h"
 #include "Configuration/ParseException.h"
@@ -18,6 +19,8 @@
 #include "Limits.h"               // homingAxes
 #include "SettingsDefinitions.h"  // build_info
 #include "Protocol.h"             // LINE_BUFFER_SIZE
+#include "Stepper.h"              // Stepper::stats
+#include "CompiledGCode.h"        // CompiledGCode::isBlock()
 #include "UartChannel.h"          // Uart0.write()
 #include "FileStream.h"           // FileStream()
 #include "xmodem.h"               // xmodemReceive(), xmodemTransmit()
@@ -26,6 +29,7 @@
 
 #include "FluidPath.h"
 #include "HashFS.h"
+#include "string_util.h"
 
 #include <cstring>
 #include <map>
@@ -742,14 +746,15 @@ static Error xmodem_send(const char* value, WebUI::AuthenticationLevel auth_leve
 }
 
 static Error dump_config(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
-    Channel* ss;
+    Channel*    ss;
+    FileStream* file = nullptr;
     if (value) {
         // Use a file on the local file system unless there is an explicit prefix like /sd/
         std::error_code ec;
 
         try {
             //            ss = new FileStream(std::string(value), "", "w");
-            ss = new FileStream(value, "w", "");
+            ss = file = new FileStream(value, "w", "");
         } catch (Error err) { return err; }
     } else {
         ss = &out;
@@ -758,9 +763,11 @@ static Error dump_config(const char* value, WebUI::AuthenticationLevel auth_leve
         Configuration::Generator generator(*ss);
         config->group(generator);
     } catch (std::exception& ex) { log_info("Config dump error: " << ex.what()); }
-    if (value) {
+    if (file) {
         drain_messages();
-        delete ss;
+        std::filesystem::path fname = file->fpath();
+        delete file;
+        HashFS::rehash_file(fname);
     }
     return Error::Ok;
 }
@@ -789,6 +796,36 @@ static Error showStartupLog(const char* value, WebUI::AuthenticationLevel auth_l
     return Error::Ok;
 }
 
+// $Stats shows the segment buffer starvation statistics, $Stats=Clear resets them
+static Error showStepperStats(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        if (strcasecmp(value, "Clear")) {
+            return Error::InvalidValue;
+        }
+        Stepper::reset_stats();
+        return Error::Ok;
+    }
+    log_info_to(out, "Segment underruns: " << Stepper::stats.underruns.load());
+    log_info_to(out, "Minimum segment fill: " << Stepper::min_segment_fill());
+    log_info_to(out, "Planner starved: " << Stepper::starved_seconds() << " s");
+    return Error::Ok;
+}
+
+// $LS shows how often log messages had to wait or were dropped, $LS=Clear resets the counts
+static Error showLogStats(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        if (strcasecmp(value, "Clear")) {
+            return Error::InvalidValue;
+        }
+        reset_log_stats();
+        return Error::Ok;
+    }
+    log_info_to(out, "Free log lines: " << free_log_lines() << " Minimum: " << log_stats.min_free.load());
+    log_info_to(out, "Log messages blocked: " << log_stats.blocked.load() << " Dropped: " << log_stats.dropped.load());
+    log_info_to(out, "Log messages too long for a line: " << log_stats.oversize.load());
+    return Error::Ok;
+}
+
 static Error showGPIOs(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
     gpio_dump(out);
     return Error::Ok;
@@ -825,6 +862,55 @@ static Error setReportInterval(const char* value, WebUI::AuthenticationLevel aut
     return Error::Ok;
 }
 
+// $RT=ON sends telemetry frames instead of text auto reports on this channel, $RT=OFF goes back to text
+static Error setTelemetry(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (!value) {
+        log_info_to(out, out.name() << " telemetry is " << (out.getTelemetry() ? "on" : "off"));
+        return Error::Ok;
+    }
+    if (!strcasecmp(value, "ON")) {
+        out.setTelemetry(true);
+    } else if (!strcasecmp(value, "OFF")) {
+        out.setTelemetry(false);
+    } else {
+        return Error::InvalidValue;
+    }
+    return Error::Ok;
+}
+
+// $CW shows the receive window of this channel, $CW=<bytes> sets it
+static Error setRxWindow(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        char* endptr;
+        long  intValue = strtol(value, &endptr, 10);
+        if (endptr == value || *endptr != '\0') {
+            return Error::BadNumberFormat;
+        }
+        if (intValue < long(Channel::minRxWindow) || intValue > long(Channel::maxRxWindow)) {
+            log_error_to(out, "Receive window must be " << Channel::minRxWindow << " to " << Channel::maxRxWindow << " bytes");
+            return Error::InvalidValue;
+        }
+        out.setRxWindow(uint32_t(intValue));
+    }
+    log_info_to(out, out.name() << " receive window is " << out.getRxWindow() << " bytes");
+    return Error::Ok;
+}
+
+// $CS=ON batches the acks of this channel and enlarges its receive window, $CS=OFF acks each line
+static Error setStreaming(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (value) {
+        if (!strcasecmp(value, "ON")) {
+            out.setStreaming(true);
+        } else if (!strcasecmp(value, "OFF")) {
+            out.setStreaming(false);
+        } else {
+            return Error::InvalidValue;
+        }
+    }
+    log_info_to(out, out.name() << " streaming is " << (out.getStreaming() ? "on" : "off") << ", receive window " << out.getRxWindow());
+    return Error::Ok;
+}
+
 static Error showHeap(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
     log_info("Heap free: " << xPortGetFreeHeapSize() << " min: " << heapLowWater);
     return Error::Ok;
@@ -839,6 +925,8 @@ void make_user_commands() {
     new UserCommand("GD", "GPIO/Dump", showGPIOs, anyState);
 
     new UserCommand("CI", "Channel/Info", showChannelInfo, anyState);
+    new UserCommand("CW", "Channel/Window", setRxWindow, anyState);
+    new UserCommand("CS", "Channel/Streaming", setStreaming, anyState);
     new UserCommand("XR", "Xmodem/Receive", xmodem_receive, notIdleOrAlarm);
     new UserCommand("XS", "Xmodem/Send", xmodem_send, notIdleOrAlarm);
     new UserCommand("CD", "Config/Dump", dump_config, anyState);
@@ -882,6 +970,7 @@ void make_user_commands() {
     new UserCommand("LI", "Log/Info", cmd_log_info, anyState);
     new UserCommand("LD", "Log/Debug", cmd_log_debug, anyState);
     new UserCommand("LV  ", "Log/Verbose", cmd_log_verbose, anyState);
+    new UserCommand("LS", "Log/Stats", showLogStats, anyState);
 
     new UserCommand("SLP", "System/Sleep", go_to_sleep, notIdleOrAlarm);
     new UserCommand("I", "Build/Info", get_report_build_info, notIdleOrAlarm);
@@ -890,8 +979,10 @@ void make_user_commands() {
 
     new UserCommand("Heap", "Heap/Show", showHeap, anyState);
     new UserCommand("SS", "Startup/Show", showStartupLog, anyState);
+    new UserCommand("Stats", "Stepper/Stats", showStepperStats, anyState);
 
     new UserCommand("RI", "Report/Interval", setReportInterval, anyState);
+    new UserCommand("RT", "Report/Telemetry", setTelemetry, anyState);
 
     new UserCommand("30", "FakeMaxSpindleSpeed", fakeMaxSpindleSpeed, notIdleOrAlarm);
     new UserCommand("32", "FakeLaserMode", fakeLaserMode, notIdleOrAlarm);
@@ -929,6 +1020,43 @@ char* normalize_key(char* start) {
     return start;
 }
 
+// Indexes of Setting::List and Command::List by name, so that a $ line does not
+// have to compare its key with every setting and command.  They are rebuilt when
+// a list grows.  As with a search of the list, the first of several entries with
+// the same name wins.
+using SettingIndex = std::map<std::string_view, Setting*, string_util::ignore_case_less>;
+using CommandIndex = std::map<std::string_view, Command*, string_util::ignore_case_less>;
+
+static SettingIndex settingsByName;
+static SettingIndex settingsByGrblName;
+static CommandIndex commandsByName;  // By name and by Grbl name
+static size_t       indexedSettings = 0;
+static size_t       indexedCommands = 0;
+
+static void index_words() {
+    if (indexedSettings != Setting::List.size()) {
+        settingsByName.clear();
+        settingsByGrblName.clear();
+        for (Setting* s : Setting::List) {
+            settingsByName.emplace(s->getName(), s);
+            if (s->getGrblName()) {
+                settingsByGrblName.emplace(s->getGrblName(), s);
+            }
+        }
+        indexedSettings = Setting::List.size();
+    }
+    if (indexedCommands != Command::List.size()) {
+        commandsByName.clear();
+        for (Command* cp : Command::List) {
+            commandsByName.emplace(cp->getName(), cp);
+            if (cp->getGrblName()) {
+                commandsByName.emplace(cp->getGrblName(), cp);
+            }
+        }
+        indexedCommands = Command::List.size();
+    }
+}
+
 // This is the handler for all forms of settings commands,
 // $..= and [..], with and without a value.
 Error do_command_or_setting(const char* key, const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
@@ -942,7 +1070,11 @@ Error do_command_or_setting(const char* key, const char* value, WebUI::Authentic
     // value if one is given, otherwise display the current value
     try {
         Configuration::RuntimeSetting rts(key, value, out);
-        config->group(rts);
+        if (Configuration::PathIndex::built()) {
+            rts.handleIndexed();
+        } else {
+            config->group(rts);
+        }
 
         if (rts.isHandled_) {
             if (value) {
@@ -970,47 +1102,49 @@ Error do_command_or_setting(const char* key, const char* value, WebUI::Authentic
         return Error::ConfigurationInvalid;
     }
 
-    // Next search the settings list by text name. If found, set a new
+    index_words();
+
+    // Next search the settings by text name. If found, set a new
     // value if one is given, otherwise display the current value
-    for (Setting* s : Setting::List) {
-        if (strcasecmp(s->getName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(uriDecode(value));
-            } else {
-                show_setting(s->getName(), s->getStringValue(), NULL, out);
-                return Error::Ok;
-            }
+    auto sit = settingsByName.find(key);
+    if (sit != settingsByName.end()) {
+        Setting* s = sit->second;
+        if (auth_failed(s, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
+        if (value) {
+            return s->setStringValue(uriDecode(value));
+        } else {
+            show_setting(s->getName(), s->getStringValue(), NULL, out);
+            return Error::Ok;
         }
     }
 
-    // Then search the setting list by compatible name.  If found, set a new
+    // Then search the settings by compatible name.  If found, set a new
     // value if one is given, otherwise display the current value in compatible mode
-    for (Setting* s : Setting::List) {
-        if (s->getGrblName() && strcasecmp(s->getGrblName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(uriDecode(value));
-            } else {
-                show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
-                return Error::Ok;
-            }
+    sit = settingsByGrblName.find(key);
+    if (sit != settingsByGrblName.end()) {
+        Setting* s = sit->second;
+        if (auth_failed(s, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
+        if (value) {
+            return s->setStringValue(uriDecode(value));
+        } else {
+            show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
+            return Error::Ok;
         }
     }
     // If we did not find a setting, look for a command.  Commands
     // handle values internally; you cannot determine whether to set
     // or display solely based on the presence of a value.
-    for (Command* cp : Command::List) {
-        if ((strcasecmp(cp->getName(), key) == 0) || (cp->getGrblName() && strcasecmp(cp->getGrblName(), key) == 0)) {
-            if (auth_failed(cp, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            return cp->action(value, auth_level, out);
+    auto cit = commandsByName.find(key);
+    if (cit != commandsByName.end()) {
+        Command* cp = cit->second;
+        if (auth_failed(cp, value, auth_level)) {
+            return Error::AuthenticationFailed;
         }
+        return cp->action(value, auth_level, out);
     }
 
     // If we did not find an exact match and there is no value,
@@ -1097,9 +1231,14 @@ Error execute_line(char* line, Channel& channel, WebUI::AuthenticationLevel auth
     if (sys.state == State::Alarm || sys.state == State::ConfigAlarm || sys.state == State::Jog) {
         return Error::SystemGcLock;
     }
-    Error result = gc_execute_line(line);
+    bool  compiled = CompiledGCode::isBlock(line);
+    Error result   = gc_execute_line(line);
     if (result != Error::Ok) {
-        log_debug_to(channel, "Bad GCode: " << line);
+        if (compiled) {
+            log_debug_to(channel, "Bad GCode in compiled block");
+        } else {
+            log_debug_to(channel, "Bad GCode: " << line);
+        }
     }
     return result;
 }
@@ -102,13 +102,20 @@ void output_loop(void* unused) {
         // Block until a message is received
         LogMessage message;
         if (xQueueReceive(message_queue, &message, portMAX_DELAY)) {
-            if (message.isString) {
-                std::string* s = static_cast<std::string*>(message.line);
-                message.channel->print_msg(message.level, s->c_str());
-                delete s;
-            } else {
-                const char* cp = static_cast<const char*>(message.line);
-                message.channel->print_msg(message.level, cp);
+            switch (message.kind) {
+                case LogKind::Fixed:
+                    message.channel->print_msg(message.level, static_cast<const char*>(message.line));
+                    break;
+                case LogKind::String: {
+                    std::string* s = static_cast<std::string*>(message.line);
+                    message.channel->print_msg(message.level, s->c_str());
+                    delete s;
+                } break;
+                case LogKind::Pooled: {
+                    LogLine* line = static_cast<LogLine*>(message.line);
+                    message.channel->print_msg(message.level, line->text);
+                    LogLine::release(line);
+                } break;
             }
         }
     }
@@ -118,7 +125,7 @@ Channel* activeChannel = nullptr;  // Channel associated with the input line
 
 TaskHandle_t pollingTask = nullptr;
 
-char activeLine[Channel::maxLine];
+char activeLine[Channel::maxLine + 1];  // InputFile::readLine() can fill maxLine characters
 
 bool pollingPaused = false;
 void polling_loop(void* unused) {
@@ -142,6 +149,66 @@ void polling_loop(void* unused) {
     }
 }
 
+// True in the states in which the step segment buffer must be kept full
+static bool motion_state() {
+    switch (sys.state) {
+        case State::ConfigAlarm:
+        case State::Alarm:
+        case State::CheckMode:
+        case State::Idle:
+        case State::Sleep:
+            return false;
+        case State::Cycle:
+        case State::Hold:
+        case State::SafetyDoor:
+        case State::Homing:
+        case State::Jog:
+            return true;
+    }
+    return false;
+}
+
+TaskHandle_t motionTask = nullptr;
+
+// Keeps the step segment buffer full from the support core, so that segment preparation does
+// not stall while the main loop is busy parsing or waiting for a line.  Once the task runs, the
+// main loop leaves prep_buffer() to it.  Prep can only get further when the planner adds a block
+// or the stepping ISR frees a segment, and both of them notify the task, so it sleeps otherwise.
+// The protocol calls prep_buffer() itself to fill the buffer before it starts a motion.
+void motion_loop(void* unused) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (motion_state()) {
+            Stepper::prep_buffer();
+        }
+    }
+}
+
+void notify_motion_task() {
+    if (motionTask) {
+        xTaskNotifyGive(motionTask);
+    }
+}
+
+void IRAM_ATTR notify_motion_task_from_ISR() {
+    if (motionTask) {
+        vTaskNotifyGiveFromISR(motionTask, NULL);
+    }
+}
+
+void start_motion_task() {
+    if (!motionTask) {
+        xTaskCreatePinnedToCore(motion_loop,       // task
+                                "motion",          // name for task
+                                4096,              // size of task stack
+                                0,                 // parameters
+                                3,                 // priority
+                                &motionTask,       // task handle
+                                SUPPORT_TASK_CORE  // core
+        );
+    }
+}
+
 void stop_polling() {
     if (pollingTask) {
         vTaskSuspend(pollingTask);
@@ -169,6 +236,7 @@ void start_polling() {
                                 &outputTask,       // task handle
                                 SUPPORT_TASK_CORE  // core
         );
+        start_motion_task();
     }
 }
 
@@ -260,6 +328,7 @@ void     protocol_main_loop() {
 // Block until all buffered steps are executed or in a cycle state. Works with feed hold
 // during a synchronize call, if it should happen. Also, waits for clean cycle end.
 void protocol_buffer_synchronize() {
+    mc_flush_blend();
     do {
         // Restart motion if there are blocks in the planner queue
         protocol_auto_cycle_start();
@@ -277,6 +346,9 @@ void protocol_buffer_synchronize() {
 // is finished, single commands), a command that needs to wait for the motions in the buffer to
 // execute calls a buffer sync, or the planner buffer is full and ready to go.
 void protocol_auto_cycle_start() {
+    if (plan_get_current_block() == NULL) {
+        mc_flush_blend();  // Nothing left to blend with before the machine would stop.
+    }
     if (plan_get_current_block() != NULL && sys.state != State::Cycle &&
         sys.state != State::Hold) {             // Check if there are any blocks in the buffer.
         protocol_send_event(&cycleStartEvent);  // If so, execute them
@@ -372,7 +444,7 @@ static void protocol_do_start() {
 }
 
 static void protocol_do_alarm(void* alarmVoid) {
-    lastAlarm = (ExecAlarm)((int)alarmVoid);
+    lastAlarm = (ExecAlarm)((intptr_t)alarmVoid);
     if (spindle->_off_on_alarm) {
         spindle->stop();
     }
@@ -394,6 +466,7 @@ static void protocol_do_alarm(void* alarmVoid) {
 
 static void protocol_start_holding() {
     if (!(sys.suspend.bit.motionCancel || sys.suspend.bit.jogCancel)) {  // Block, if already holding.
+        Stepper::Lock lock;
         sys.step_control = {};
         if (!Stepper::update_plan_block_parameters()) {  // Notify stepper module to recompute for hold deceleration.
             sys.step_control.endMotion = true;
@@ -514,6 +587,7 @@ static void protocol_do_safety_door() {
             if (!sys.suspend.bit.jogCancel && sys.suspend.bit.initiateRestore) {  // Actively restoring
                 // Set hold and reset appropriate control flags to restart parking sequence.
                 if (sys.step_control.executeSysMotion) {
+                    Stepper::Lock lock;
                     Stepper::update_plan_block_parameters();  // Notify stepper module to recompute for hold deceleration.
                     sys.step_control                  = {};
                     sys.step_control.executeHold      = true;
@@ -585,6 +659,7 @@ void protocol_cancel_disable_steppers() {
 static void protocol_do_initiate_cycle() {
     // log_debug("protocol_do_initiate_cycle " << state_name());
     // Start cycle only if queued motions exist in planner buffer and the motion is not canceled.
+    Stepper::Lock lock;
     sys.step_control = {};  // Restore step control to normal operation
     plan_block_t* pb;
     if ((pb = plan_get_current_block()) && !sys.suspend.bit.motionCancel) {
@@ -599,6 +674,7 @@ static void protocol_do_initiate_cycle() {
 }
 static void protocol_initiate_homing_cycle() {
     // log_debug("protocol_initiate_homing_cycle " << state_name());
+    Stepper::Lock lock;
     sys.step_control                  = {};    // Restore step control to normal operation
     sys.suspend.value                 = 0;     // Break suspend state.
     sys.step_control.executeSysMotion = true;  // Set to execute homing motion and clear existing flags.
@@ -692,6 +768,7 @@ void protocol_do_cycle_stop() {
             if (!soft_limit && !sys.suspend.bit.jogCancel) {
                 // Hold complete. Set to indicate ready to resume.  Remain in HOLD or DOOR states until user
                 // has issued a resume command or reset.
+                Stepper::Lock lock;
                 plan_cycle_reinitialize();
                 if (sys.step_control.executeHold) {
                     sys.suspend.bit.holdComplete = true;
@@ -711,6 +788,7 @@ void protocol_do_cycle_stop() {
             // Motion complete. Includes CYCLE/JOG/HOMING states and jog cancel/motion cancel/soft limit events.
             // NOTE: Motion and jog cancel both immediately return to idle after the hold completes.
             if (sys.suspend.bit.jogCancel) {  // For jog cancel, flush buffers and sync positions.
+                Stepper::Lock lock;
                 sys.step_control = {};
                 plan_reset();
                 Stepper::reset();
@@ -764,21 +842,9 @@ void protocol_exec_rt_system() {
 
     protocol_handle_events();
 
-    // Reload step segment buffer
-    switch (sys.state) {
-        case State::ConfigAlarm:
-        case State::Alarm:
-        case State::CheckMode:
-        case State::Idle:
-        case State::Sleep:
-            break;
-        case State::Cycle:
-        case State::Hold:
-        case State::SafetyDoor:
-        case State::Homing:
-        case State::Jog:
-            Stepper::prep_buffer();
-            break;
+    // Reload step segment buffer, unless the motion task does it
+    if (!motionTask && motion_state()) {
+        Stepper::prep_buffer();
     }
 }
 
@@ -802,6 +868,7 @@ static void protocol_manage_spindle() {
                 report_feedback_message(Message::SpindleRestore);
                 if (spindle->isRateAdjusted()) {
                     // When in laser mode, defer turn on until cycle starts
+                    Stepper::Lock lock;
                     sys.step_control.updateSpindleSpeed = true;
                 } else {
                     config->_parking->restore_spindle();
@@ -816,10 +883,17 @@ static void protocol_manage_spindle() {
     } else {
         // Handles spindle state during hold. NOTE: Spindle speed overrides may be altered during hold state.
         // NOTE: sys.step_control.updateSpindleSpeed is automatically reset upon resume in step generator.
-        if (sys.step_control.updateSpindleSpeed) {
-            config->_parking->restore_spindle();
+        // The flag is taken under the lock, but the spindle, which can wait for spin-up or a VFD, is
+        // set after releasing it.
+        bool update;
+        {
+            Stepper::Lock lock;
+            update                              = sys.step_control.updateSpindleSpeed;
             sys.step_control.updateSpindleSpeed = false;
         }
+        if (update) {
+            config->_parking->restore_spindle();
+        }
     }
 }
 
@@ -899,7 +973,7 @@ static void protocol_exec_rt_suspend() {
 }
 
 static void protocol_do_feed_override(void* incrementvp) {
-    int increment = int(incrementvp);
+    int increment = int(intptr_t(incrementvp));
     int percent;
     if (increment == FeedOverride::Default) {
         percent = FeedOverride::Default;
@@ -918,7 +992,7 @@ static void protocol_do_feed_override(void* incrementvp) {
 }
 
 static void protocol_do_rapid_override(void* percentvp) {
-    int percent = int(percentvp);
+    int percent = int(intptr_t(percentvp));
     if (percent != sys.r_override) {
         sys.r_override = percent;
         update_velocities();
@@ -927,7 +1001,7 @@ static void protocol_do_rapid_override(void* percentvp) {
 
 static void protocol_do_spindle_override(void* incrementvp) {
     int percent;
-    int increment = int(incrementvp);
+    int increment = int(intptr_t(incrementvp));
     if (increment == SpindleSpeedOverride::Default) {
         percent = SpindleSpeedOverride::Default;
     } else {
@@ -939,9 +1013,12 @@ static void protocol_do_spindle_override(void* incrementvp) {
         }
     }
     if (percent != sys.spindle_speed_ovr) {
-        sys.spindle_speed_ovr               = percent;
-        sys.step_control.updateSpindleSpeed = true;
-        report_ovr_counter                  = 0;  // Set to report change immediately
+        {
+            Stepper::Lock lock;
+            sys.spindle_speed_ovr               = percent;
+            sys.step_control.updateSpindleSpeed = true;
+        }
+        report_ovr_counter = 0;  // Set to report change immediately
 
         // If spindle is on, tell it the RPM has been overridden
         // When moving, the override is handled by the stepping code
@@ -953,7 +1030,7 @@ static void protocol_do_spindle_override(void* incrementvp) {
 }
 
 static void protocol_do_accessory_override(void* type) {
-    switch (int(type)) {
+    switch (int(intptr_t(type))) {
         case AccessoryOverride::SpindleStopOvr:
             // Spindle stop override allowed only while in HOLD state.
             if (sys.state == State::Hold) {
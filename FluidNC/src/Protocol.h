@@ -30,6 +30,14 @@ void protocol_init();
 // them as they complete. It is also responsible for finishing the initialization procedures.
 void protocol_main_loop();
 
+// Starts the task that prepares step segments on the support core. protocol_main_loop() starts it.
+void start_motion_task();
+
+// Wakes the motion task, if it is running, to prepare more step segments. The planner calls it
+// when it adds a block, and the stepping ISR when it finishes a segment.
+void notify_motion_task();
+void notify_motion_task_from_ISR();
+
 // Checks and executes a realtime command at various stop points in main program
 void protocol_execute_realtime();
 void protocol_exec_rt_system();
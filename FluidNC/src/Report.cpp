@@ -84,13 +84,56 @@ Counter report_wco_counter = 0;
 static const int coordStringLen = 20;
 static const int axesStringLen  = coordStringLen * MAX_N_AXIS;
 
-// Sends the axis values to the output channel
-static std::string report_util_axis_values(const float* axis_value) {
-    std::ostringstream msg;
-    auto               n_axis = config->_axes->_numberAxis;
+void report_fixed(Print& out, float value, int decimals) {
+    static const uint32_t scales[] = { 1, 10, 100, 1000, 10000 };
+
+    bool negative = value < 0;
+    if (negative) {
+        value = -value;
+    }
+    if (!(value < 4e9f)) {
+        out.print(negative ? -value : value, decimals);  // Too big for the integer part, or NaN
+        return;
+    }
+    // The integer part and the fraction are converted separately, so float precision is enough
+    uint32_t scale    = scales[decimals];
+    uint32_t integer  = uint32_t(value);
+    uint32_t fraction = uint32_t(lroundf((value - integer) * scale));
+    if (fraction >= scale) {
+        fraction -= scale;
+        ++integer;
+    }
+
+    char  buf[20];
+    char* p = buf + sizeof(buf);
+    *--p    = '\0';
+    for (int i = 0; i < decimals; ++i) {
+        *--p = '0' + fraction % 10;
+        fraction /= 10;
+    }
+    if (decimals) {
+        *--p = '.';
+    }
+    do {
+        *--p = '0' + integer % 10;
+        integer /= 10;
+    } while (integer);
+    if (negative) {
+        *--p = '-';
+    }
+    out.write(reinterpret_cast<const uint8_t*>(p), buf + sizeof(buf) - 1 - p);
+}
+
+// Streams the axis values, separated by commas
+struct AxisValues {
+    const float* values;
+};
+
+static Print& operator<<(Print& out, AxisValues axis_values) {
+    auto n_axis = config->_axes->_numberAxis;
     for (size_t idx = 0; idx < n_axis; idx++) {
         int   decimals;
-        float value = axis_value[idx];
+        float value = axis_values.values[idx];
         if (idx >= A_AXIS && idx <= C_AXIS) {
             // Rotary axes are in degrees so mm vs inch is not
             // relevant.  Three decimal places is probably overkill
@@ -105,12 +148,17 @@ static std::string report_util_axis_values(const float* axis_value) {
                 decimals = 3;  // Report mm to 3 decimal places
             }
         }
-        msg << std::fixed << std::setprecision(decimals) << value;
+        report_fixed(out, value, decimals);
         if (idx < (n_axis - 1)) {
-            msg << ",";
+            out << ",";
         }
     }
-    return msg.str();
+    return out;
+}
+
+// Wraps the axis values so that << formats them straight into the stream
+static AxisValues report_util_axis_values(const float* axis_value) {
+    return { axis_value };
 }
 
 std::map<Message, const char*> MessageText = {
@@ -325,6 +373,11 @@ void report_gcode_modes(Channel& channel) {
             break;
     }
 
+    // G61 is the default and is not reported, so that the report is unchanged unless G64 is in use.
+    if (gc_state.modal.control == ControlMode::Continuous) {
+        msg << " G64";
+    }
+
     //report_util_gcode_modes_M();
     switch (gc_state.modal.program_flow) {
         case ProgramFlow::Running:
@@ -538,13 +591,17 @@ void report_realtime_status(Channel& channel) {
         msg << "|WPos:";
         mpos_to_wpos(print_position);
     }
-    msg << report_util_axis_values(print_position).c_str();
+    msg << report_util_axis_values(print_position);
 
     // Returns planner and serial read buffer states.
 
     if (bits_are_true(status_mask->get(), RtStatus::Buffer)) {
         msg << "|Bf:" << plan_get_block_buffer_available() << "," << channel.rx_buffer_available();
     }
+    if (bits_are_true(status_mask->get(), RtStatus::Segments)) {
+        // Segment underruns and the minimum segment buffer fill
+        msg << "|Sg:" << Stepper::stats.underruns.load() << "," << Stepper::min_segment_fill();
+    }
 
     if (config->_useLineNumbers) {
         // Report current line number
@@ -562,7 +619,9 @@ void report_realtime_status(Channel& channel) {
     if (config->_reportInches) {
         rate /= MM_PER_INCH;
     }
-    msg << "|FS:" << setprecision(0) << rate << "," << sys.spindle_speed;
+    msg << "|FS:";
+    report_fixed(msg, rate, 0);
+    msg << "," << sys.spindle_speed;
 
     if (report_pin_string.length()) {
         msg << "|Pn:" << report_pin_string;
@@ -585,7 +644,7 @@ void report_realtime_status(Channel& channel) {
         if (report_ovr_counter == 0) {
             report_ovr_counter = 1;  // Set override on next report.
         }
-        msg << "|WCO:" << report_util_axis_values(get_wco()).c_str();
+        msg << "|WCO:" << report_util_axis_values(get_wco());
     }
 
     if (report_ovr_counter > 0) {
@@ -630,9 +689,7 @@ void report_realtime_status(Channel& channel) {
             }
         }
     }
-    if (InputFile::_progress.length()) {
-        msg << "|" + InputFile::_progress;
-    }
+    InputFile::report_progress(msg);
 #ifdef DEBUG_STEPPER_ISR
     msg << "|ISRs:" << Stepper::isr_count;
 #endif
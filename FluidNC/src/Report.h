@@ -19,6 +19,7 @@
 enum RtStatus {
     Position = bitnum_to_mask(0),
     Buffer   = bitnum_to_mask(1),
+    Segments = bitnum_to_mask(2),
 };
 
 const char* errorString(Error errorNumber);
@@ -63,6 +64,10 @@ void report_echo_line_received(char* line, Channel& channel);
 // Prints realtime status report
 void report_realtime_status(Channel& channel);
 
+// Prints value with a fixed number of decimals, 0 to 4, rounded half away from zero.
+// Unlike std::fixed formatting, it needs no stream or heap.
+void report_fixed(Print& out, float value, int decimals);
+
 // Prints recorded probe position
 void report_probe_parameters(Channel& channel);
 
@@ -7,6 +7,7 @@
 
 #include <string_view>
 #include <map>
+#include <functional>
 #include <nvs.h>
 #include <string_view>
 
@@ -8,6 +8,8 @@
 
 StringSetting* config_filename;
 
+EnumSetting* config_snapshot;
+
 StringSetting* build_info;
 
 StringSetting* start_message;
@@ -71,8 +73,10 @@ void make_settings() {
 
     config_filename = new StringSetting("Name of Configuration File", EXTENDED, WG, NULL, "Config/Filename", "config.yaml", 1, 50);
 
+    config_snapshot = new EnumSetting("Load configuration from a snapshot", EXTENDED, WG, NULL, "Config/Snapshot", 0, &onoffOptions);
+
     // GRBL Numbered Settings
-    status_mask = new IntSetting("What to include in status report", GRBL, WG, "10", "Report/Status", 1, 0, 3);
+    status_mask = new IntSetting("What to include in status report", GRBL, WG, "10", "Report/Status", 1, 0, 7);
 
     sd_fallback_cs = new IntSetting("SD CS pin if not configured", EXTENDED, WG, NULL, "SD/FallbackCS", -1, -1, 40);
 
@@ -0,0 +1,115 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Lock-free ring buffer with one producer and one consumer, which can run on different cores or
+// in an interrupt handler.
+//
+// Positions are free-running counters that are masked to index the storage, so advancing one is a
+// single increment with no compare and wrap. The storage is sized to the next power of two above the
+// capacity, so back() is always a free entry, even when the ring is full.
+//
+// The producer fills back() and publishes it with push(). The consumer reads front() and releases it
+// with pop(). Each side writes only its own position, with a release store, and reads the other with
+// an acquire load, so an entry is completely written before the other side can see it.
+//
+// The entries from tail() up to head() can be visited with at(). index() gives the storage index of
+// a position, for data that is kept in a parallel array.
+//
+// Rings of bytes and other plain data can also be filled with write() and drained with read(), which
+// copy many entries at once, or drained in place, a contiguous run at a time, with contiguous() and
+// pop(n).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class SpscRing {
+    T*                    _entries  = nullptr;
+    uint32_t              _mask     = 0;
+    uint32_t              _capacity = 0;
+    std::atomic<uint32_t> _head { 0 };  // Written only by the producer
+    std::atomic<uint32_t> _tail { 0 };  // Written only by the consumer
+
+public:
+    SpscRing() = default;
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    ~SpscRing() { delete[] _entries; }
+
+    // Allocates the storage for up to capacity entries and empties the ring. Neither side may be using it.
+    void init(uint32_t capacity) {
+        uint32_t slots = 1;
+        while (slots <= capacity) {
+            slots <<= 1;
+        }
+        delete[] _entries;
+        _entries  = new T[slots];
+        _mask     = slots - 1;
+        _capacity = capacity;
+        clear();
+    }
+
+    // Empties the ring. Neither side may be using it.
+    void clear() {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t capacity() const { return _capacity; }
+    uint32_t slots() const { return _mask + 1; }  // Number of entries in the storage
+
+    // The accessors are forced inline because the stepper interrupt handler, which must run from IRAM,
+    // uses them.
+    inline uint32_t head() const __attribute__((always_inline)) { return _head.load(std::memory_order_acquire); }  // Position of back()
+    inline uint32_t tail() const __attribute__((always_inline)) { return _tail.load(std::memory_order_acquire); }  // Position of front()
+
+    inline uint32_t count() const __attribute__((always_inline)) { return head() - tail(); }
+    inline uint32_t available() const __attribute__((always_inline)) { return _capacity - count(); }
+    inline bool     empty() const __attribute__((always_inline)) { return head() == tail(); }
+    inline bool     full() const __attribute__((always_inline)) { return count() >= _capacity; }
+
+    inline uint32_t index(uint32_t position) const __attribute__((always_inline)) { return position & _mask; }
+    inline T&       at(uint32_t position) __attribute__((always_inline)) { return _entries[position & _mask]; }
+
+    // Consumer side
+    inline T&   front() __attribute__((always_inline)) { return at(_tail.load(std::memory_order_relaxed)); }
+    inline void pop() __attribute__((always_inline)) { _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Producer side
+    inline T&   back() __attribute__((always_inline)) { return at(_head.load(std::memory_order_relaxed)); }
+    inline void push() __attribute__((always_inline)) { _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer side. The number of queued entries from front() to the end of the storage.
+    uint32_t contiguous() const {
+        uint32_t position = _tail.load(std::memory_order_relaxed);
+        return std::min(head() - position, slots() - index(position));
+    }
+
+    // Consumer side. Releases n entries, which must be queued.
+    void pop(uint32_t n) { _tail.store(_tail.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    // Producer side. Copies up to length entries into the ring and returns the number copied.
+    uint32_t write(const T* data, uint32_t length) {
+        uint32_t position = _head.load(std::memory_order_relaxed);
+        uint32_t n        = std::min(length, _capacity - (position - tail()));
+        uint32_t first    = std::min(n, slots() - index(position));
+        std::copy(data, data + first, _entries + index(position));
+        std::copy(data + first, data + n, _entries);
+        _head.store(position + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side. Copies up to length entries out of the ring and returns the number copied.
+    uint32_t read(T* data, uint32_t length) {
+        uint32_t position = _tail.load(std::memory_order_relaxed);
+        uint32_t n        = std::min(length, head() - position);
+        uint32_t first    = std::min(n, slots() - index(position));
+        std::copy(_entries + index(position), _entries + index(position) + first, data);
+        std::copy(_entries, _entries + (n - first), data + first);
+        _tail.store(position + n, std::memory_order_release);
+        return n;
+    }
+};
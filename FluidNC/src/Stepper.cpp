@@ -15,7 +15,11 @@
 #include "StepperPrivate.h"
 #include "Planner.h"
 #include "Protocol.h"
+#include "SpscRing.h"
 #include <esp_attr.h>  // IRAM_ATTR
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
 #include <cmath>
 
 using namespace Stepper;
@@ -35,6 +39,7 @@ struct st_block_t {
     bool     is_pwm_rate_adjusted;  // Tracks motions that require constant laser power/rate
 };
 static volatile st_block_t* st_block_buffer = nullptr;
+static uint32_t             st_block_mask   = 0;  // The size of st_block_buffer is a power of two
 
 // Primary stepper segment ring buffer. Contains small, short line segments for the stepper
 // algorithm to execute, which are "checked-out" incrementally from the first block in the
@@ -48,17 +53,30 @@ struct segment_t {
     uint32_t     spindle_dev_speed;  // Spindle speed scaled to the device
     SpindleSpeed spindle_speed;      // Spindle speed in GCode units
 };
-static segment_t* segment_buffer = nullptr;
+static SpscRing<segment_t> segment_buffer;
+
+static SemaphoreHandle_t prep_mutex = nullptr;  // See Stepper::lock()
+
+// The mutex is created by the first call, which happens during startup before the motion task runs.
+void Stepper::lock() {
+    if (!prep_mutex) {
+        prep_mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    xSemaphoreTakeRecursive(prep_mutex, portMAX_DELAY);
+}
+
+void Stepper::unlock() {
+    xSemaphoreGiveRecursive(prep_mutex);
+}
 
 void Stepper::init() {
+    segment_buffer.init(config->_stepping->_segments - 1);
     if (st_block_buffer) {
         delete[] st_block_buffer;
     }
-    st_block_buffer = new st_block_t[config->_stepping->_segments - 1];
-    if (segment_buffer) {
-        delete[] segment_buffer;
-    }
-    segment_buffer = new segment_t[config->_stepping->_segments];
+    // One block data entry per segment is enough, and the segment ring storage is a power of two.
+    st_block_buffer = new st_block_t[segment_buffer.slots()];
+    st_block_mask   = segment_buffer.slots() - 1;
 }
 
 // Stepper ISR data struct. Contains the running data for the main stepper ISR.
@@ -80,16 +98,19 @@ typedef struct {
 } stepper_t;
 static stepper_t st;
 
-// Step segment ring buffer indices
-static volatile uint32_t segment_buffer_tail;
-static volatile uint32_t segment_buffer_head;
-static uint32_t          segment_next_head;
-
 // Pointers for the step segment being prepped from the planner buffer. Accessed only by the
 // main program. Pointers may be planning segments or planner blocks ahead of what being executed.
 static plan_block_t*        pl_block;       // Pointer to the planner block being prepped
 static volatile st_block_t* st_prep_block;  // Pointer to the stepper block data being prepped
 
+// Snapshot of pl_block != NULL for the ISR, which must not read the prep pointer itself.
+static std::atomic<bool> prep_block_loaded(false);
+
+static void set_prep_block(plan_block_t* block) {
+    pl_block = block;
+    prep_block_loaded.store(block != NULL, std::memory_order_release);
+}
+
 // Segment preparation data struct. Contains all the necessary information to compute new segments
 // based on the current executing planner block.
 typedef struct {
@@ -115,9 +136,25 @@ typedef struct {
     float accelerate_until;  // Acceleration ramp end measured from end of block (mm)
     float decelerate_after;  // Deceleration ramp start measured from end of block (mm)
 
+    // S-curve shape of the current acceleration or deceleration ramp. See start_ramp().
+    float current_accel;     // Acceleration at the end of the segment buffer (mm/min^2)
+    bool  s_curve;           // Current ramp is shaped. Otherwise it is linear at the block acceleration.
+    float ramp_start_mm;     // Ramp start measured from end of block (mm)
+    float ramp_start_speed;  // Speed at the start of the ramp (mm/min)
+    float ramp_direction;    // 1 for acceleration, -1 for deceleration. The values below are in this direction.
+    float ramp_start_accel;  // (mm/min^2)
+    float ramp_peak_accel;   // (mm/min^2)
+    float ramp_jerk;         // (mm/min^3)
+    float ramp_phase[3];     // Durations of the jerk to the peak, the peak and the jerk back to zero (min)
+    float ramp_duration;     // (min)
+    float ramp_time;         // Time into the ramp at the end of the segment buffer (min)
+
     float        inv_rate;  // Used by PWM laser mode to speed up segment calculations.
     SpindleSpeed current_spindle_speed;
 
+    bool    st_block_used;             // The stepper block data being prepped has gone out with a segment
+    int32_t arc_position[MAX_N_AXIS];  // End of the last chord of an arc block (steps). See arc_chord().
+
 } st_prep_t;
 static st_prep_t prep;
 
@@ -185,6 +222,19 @@ void IRAM_ATTR Stepper::stop_stepping() {
 uint32_t Stepper::isr_count;  // for debugging only
 #endif
 
+uint32_t Stepper::prepped_blocks;
+uint32_t Stepper::prepped_segments;
+
+Stats Stepper::stats = { 0, UINT32_MAX, 0 };
+
+// Set by prep when it finds the planner buffer empty while stepping. The ISR then adds the time of
+// each segment it loads to starved_pending, which prep moves to stats.starved_ticks if another block
+// arrives before the segment buffer runs dry. Otherwise the motion ended, and the time is dropped.
+// Prep may run on the other core, so it takes the pending time with exchange() rather than a read
+// and a separate reset that could lose what the ISR adds in between.
+static std::atomic<bool>     planner_starved(false);
+static std::atomic<uint32_t> starved_pending(0);
+
 /**
  * This phase of the ISR should ONLY create the pulses for the steppers.
  * This prevents jitter caused by the interval between the start of the
@@ -208,9 +258,25 @@ bool IRAM_ATTR Stepper::pulse_func() {
     // If there is no step segment, attempt to pop one from the stepper buffer
     if (st.exec_segment == NULL) {
         // Anything in the buffer? If so, load and initialize next step segment.
-        if (segment_buffer_head != segment_buffer_tail) {
+        if (!segment_buffer.empty()) {
+            // Only count the fill level while prep still has steps to add, so that the normal
+            // drain at the end of a motion is not mistaken for starvation.
+            if (prep_block_loaded.load(std::memory_order_acquire)) {
+                uint32_t fill = segment_buffer.count();
+                uint32_t seen = stats.min_fill.load(std::memory_order_relaxed);
+                while (fill < seen && !stats.min_fill.compare_exchange_weak(seen, fill, std::memory_order_relaxed)) {}
+            }
             // Initialize new step segment and load number of steps to execute
-            st.exec_segment = &segment_buffer[segment_buffer_tail];
+            st.exec_segment = &segment_buffer.front();
+            if (planner_starved.load(std::memory_order_relaxed)) {
+                // Saturate rather than wrap if prep stays away for a very long time.
+                uint64_t ticks   = uint64_t(st.exec_segment->n_step) * st.exec_segment->isrPeriod;
+                uint32_t pending = starved_pending.load(std::memory_order_relaxed);
+                uint32_t sum;
+                do {
+                    sum = ticks > UINT32_MAX - pending ? UINT32_MAX : pending + uint32_t(ticks);
+                } while (!starved_pending.compare_exchange_weak(pending, sum, std::memory_order_relaxed));
+            }
             // Initialize step segment timing per step and load number of steps to execute.
             config->_stepping->setTimerPeriod(st.exec_segment->isrPeriod);
             st.step_count = st.exec_segment->n_step;  // NOTE: Can sometimes be zero when moving slow.
@@ -234,6 +300,11 @@ bool IRAM_ATTR Stepper::pulse_func() {
             spindle->setSpeedfromISR(st.exec_segment->spindle_dev_speed);
         } else {
             // Segment buffer empty. Shutdown.
+            if (prep_block_loaded.load(std::memory_order_acquire) && !sys.step_control.endMotion) {
+                stats.underruns.fetch_add(1, std::memory_order_relaxed);  // Prep did not keep up
+            }
+            planner_starved.store(false, std::memory_order_relaxed);
+            starved_pending.store(0, std::memory_order_relaxed);
             stop_stepping();
             if (sys.state != State::Jog) {  // added to prevent ... jog after probing crash
                 // Ensure pwm is set properly upon completion of rate-controlled motion.
@@ -274,8 +345,9 @@ bool IRAM_ATTR Stepper::pulse_func() {
     st.step_count--;  // Decrement step events count
     if (st.step_count == 0) {
         // Segment is complete. Discard current segment and advance segment indexing.
-        st.exec_segment     = NULL;
-        segment_buffer_tail = segment_buffer_tail >= (config->_stepping->_segments - 1) ? 0 : segment_buffer_tail + 1;
+        st.exec_segment = NULL;
+        segment_buffer.pop();
+        notify_motion_task_from_ISR();
     }
 
     config->_axes->unstep();
@@ -305,6 +377,8 @@ void Stepper::go_idle() {
 
 // Reset and clear stepper subsystem variables
 void Stepper::reset() {
+    Lock lock;
+
     // Initialize Stepping driver idle state.
     config->_stepping->reset();
 
@@ -313,22 +387,21 @@ void Stepper::reset() {
     // Initialize stepper algorithm variables.
     memset(&prep, 0, sizeof(st_prep_t));
     memset(&st, 0, sizeof(stepper_t));
-    st.exec_segment     = NULL;
-    pl_block            = NULL;  // Planner block pointer used by segment buffer
-    segment_buffer_tail = 0;
-    segment_buffer_head = 0;  // empty = tail
-    segment_next_head   = 1;
-    st.step_outbits     = 0;
-    st.dir_outbits      = 0;  // Initialize direction bits to default.
+    st.exec_segment = NULL;
+    set_prep_block(NULL);  // Planner block pointer used by segment buffer
+    segment_buffer.clear();
+    st.step_outbits = 0;
+    st.dir_outbits  = 0;  // Initialize direction bits to default.
     // TODO do we need to turn step pins off?
 }
 
 // Called by planner_recalculate() when the executing block is updated by the new plan.
 bool Stepper::update_plan_block_parameters() {
+    Lock lock;
     if (pl_block != NULL) {  // Ignore if at start of a new block.
         prep.recalculate_flag.recalculate = 1;
         pl_block->entry_speed_sqr         = prep.current_speed * prep.current_speed;  // Update entry speed.
-        pl_block                          = NULL;  // Flag prep_segment() to load and check active velocity profile.
+        set_prep_block(NULL);  // Flag prep_segment() to load and check active velocity profile.
         return true;
     }
     return false;
@@ -336,6 +409,8 @@ bool Stepper::update_plan_block_parameters() {
 
 // Changes the run state of the step segment buffer to execute the special parking motion.
 void Stepper::parking_setup_buffer() {
+    Lock lock;
+
     // Store step execution data of partially completed block, if necessary.
     if (prep.recalculate_flag.holdPartialBlock) {
         prep.last_st_block_index  = prep.st_block_index;
@@ -346,11 +421,13 @@ void Stepper::parking_setup_buffer() {
     // Set flags to execute a parking motion
     prep.recalculate_flag.parking     = 1;
     prep.recalculate_flag.recalculate = 0;
-    pl_block                          = NULL;  // Always reset parking motion to reload new block.
+    set_prep_block(NULL);  // Always reset parking motion to reload new block.
 }
 
 // Restores the step segment buffer to the normal run state after a parking motion.
 void Stepper::parking_restore_buffer() {
+    Lock lock;
+
     // Restore step execution data and flags of partially completed block, if necessary.
     if (prep.recalculate_flag.holdPartialBlock) {
         st_prep_block                          = &st_block_buffer[prep.last_st_block_index];
@@ -358,6 +435,7 @@ void Stepper::parking_restore_buffer() {
         prep.steps_remaining                   = prep.last_steps_remaining;
         prep.dt_remainder                      = prep.last_dt_remainder;
         prep.step_per_mm                       = prep.last_step_per_mm;
+        prep.st_block_used                     = true;
         prep.recalculate_flag.holdPartialBlock = 1;
         prep.recalculate_flag.recalculate      = 1;
         prep.req_mm_increment                  = REQ_MM_INCREMENT_SCALAR / prep.step_per_mm;  // Recompute this value.
@@ -365,13 +443,191 @@ void Stepper::parking_restore_buffer() {
         prep.recalculate_flag = {};
     }
 
-    pl_block = NULL;  // Set to reload next block.
+    set_prep_block(NULL);  // Set to reload next block.
 }
 
 // Increments the step segment buffer block data ring buffer.
 static uint8_t next_block_index(uint8_t block_index) {
-    block_index++;
-    return block_index == (config->_stepping->_segments - 1) ? 0 : block_index;
+    return (block_index + 1) & st_block_mask;
+}
+
+// Speed gained, distance travelled beyond the start speed and acceleration at time t into the
+// shaped ramp, all in the direction of the ramp.
+static void s_curve_at(float t, float& dv, float& dx, float& accel) {
+    float jerk[3] = { prep.ramp_peak_accel >= prep.ramp_start_accel ? prep.ramp_jerk : -prep.ramp_jerk, 0.0f, -prep.ramp_jerk };
+    dv            = 0.0f;
+    dx            = 0.0f;
+    accel         = prep.ramp_start_accel;
+    for (int i = 0; i < 3 && t > 0.0f; i++) {
+        float dt = MIN(t, prep.ramp_phase[i]);
+        dx += dt * (dv + dt * (0.5f * accel + dt * jerk[i] / 6.0f));
+        dv += dt * (accel + 0.5f * dt * jerk[i]);
+        accel += dt * jerk[i];
+        t -= dt;
+    }
+}
+
+// Shapes the ramp for a peak acceleration and returns its distance.
+static float s_curve_distance(float peak_accel, float speed_change) {
+    float a0          = prep.ramp_start_accel;
+    float jerk        = prep.ramp_jerk;
+    float to_peak     = fabsf(peak_accel - a0) / jerk;
+    float from_peak   = peak_accel / jerk;
+    float jerk_change = 0.5f * ((a0 + peak_accel) * to_peak + peak_accel * from_peak);  // Speed change while jerking
+
+    prep.ramp_peak_accel = peak_accel;
+    prep.ramp_phase[0]   = to_peak;
+    prep.ramp_phase[1]   = MAX((speed_change - jerk_change) / peak_accel, 0.0f);
+    prep.ramp_phase[2]   = from_peak;
+    prep.ramp_duration   = to_peak + prep.ramp_phase[1] + from_peak;
+
+    float dv, dx, accel;
+    s_curve_at(prep.ramp_duration, dv, dx, accel);
+    return prep.ramp_start_speed * prep.ramp_duration + prep.ramp_direction * dx;
+}
+
+/* Sets up the shape of a ramp from the current speed at start_mm to to_speed at end_mm, for blocks
+   with a jerk limit, and returns where the ramp ends. The acceleration moves at the jerk limit from
+   where it is now to a peak, holds there and dies back down to zero at the end of the ramp. The peak
+   never passes the block acceleration. When a lower peak covers the same distance as the planned
+   linear ramp, the ramp ends at end_mm, so the planned speeds are unchanged. Otherwise, as the ends
+   of the ramp gain speed more slowly, the ramp is longer and runs on into the cruise, as far as
+   limit_mm.
+
+   Starting from the current acceleration keeps the acceleration continuous across block boundaries
+   and planner recalculations, which both restart the ramp. Ramps that do not fit by limit_mm, and
+   those that would have to reverse the current acceleration, stay linear.
+*/
+static float start_ramp(float start_mm, float end_mm, float to_speed, float limit_mm) {
+    prep.s_curve       = false;
+    float jerk         = pl_block->jerk;
+    float distance     = start_mm - end_mm;
+    float speed_change = fabsf(to_speed - prep.current_speed);
+    if (jerk == 0.0f || distance <= 0.0f || speed_change == 0.0f) {
+        return end_mm;
+    }
+    prep.ramp_direction   = to_speed > prep.current_speed ? 1.0f : -1.0f;
+    prep.ramp_start_speed = prep.current_speed;
+    prep.ramp_start_accel = MIN(MAX(prep.ramp_direction * prep.current_accel, 0.0f), pl_block->acceleration);
+    prep.ramp_jerk        = jerk;
+
+    float a0 = prep.ramp_start_accel;
+    if (a0 * a0 > 2.0f * jerk * speed_change) {
+        return end_mm;  // Even dropping the acceleration straight to zero overshoots to_speed.
+    }
+
+    // The distance shrinks as the peak rises, down to the block acceleration or the highest peak
+    // that only just reaches to_speed.
+    float low      = 0.0f;
+    float high     = MIN(sqrtf(jerk * speed_change + 0.5f * a0 * a0), pl_block->acceleration);
+    float shortest = s_curve_distance(high, speed_change);
+    if (shortest > start_mm - limit_mm) {
+        return end_mm;
+    }
+    if (shortest >= distance) {
+        end_mm = start_mm - shortest;
+    } else {
+        for (int i = 0; i < 20; i++) {
+            float peak = 0.5f * (low + high);
+            if (s_curve_distance(peak, speed_change) > distance) {
+                low = peak;
+            } else {
+                high = peak;
+            }
+        }
+        s_curve_distance(high, speed_change);
+    }
+    prep.ramp_start_mm = start_mm;
+    prep.ramp_time     = 0.0f;
+    prep.s_curve       = true;
+    return end_mm;
+}
+
+// The distance of the shortest shaped ramp between two speeds that starts and ends at zero
+// acceleration. The ramp is symmetric, so its average speed is the mean of the two.
+static float s_curve_length(float from_speed, float to_speed) {
+    float change = fabsf(from_speed - to_speed);
+    float peak   = MIN(pl_block->acceleration, sqrtf(pl_block->jerk * change));
+    return 0.5f * (from_speed + to_speed) * (change / peak + peak / pl_block->jerk);
+}
+
+// Advances the shaped ramp by time_var, updating the current speed and acceleration and mm_remaining.
+// Returns false, changing nothing, if that reaches the end of the ramp or end_mm.
+static bool s_curve_segment(float time_var, float end_mm, float& mm_remaining) {
+    float t = prep.ramp_time + time_var;
+    if (t >= prep.ramp_duration) {
+        return false;
+    }
+    float dv, dx, accel;
+    s_curve_at(t, dv, dx, accel);
+    float mm_var = prep.ramp_start_mm - (prep.ramp_start_speed * t + prep.ramp_direction * dx);
+    if (mm_var <= end_mm) {
+        return false;
+    }
+    prep.ramp_time     = t;
+    prep.current_speed = prep.ramp_start_speed + prep.ramp_direction * dv;
+    prep.current_accel = prep.ramp_direction * accel;
+    mm_remaining       = mm_var;
+    return true;
+}
+
+/* Sets up the Bresenham data of the segment of an arc block that ends mm_remaining from the end
+   of the block, as a chord from the end of the previous segment, and returns its step count. The
+   chords are computed as the segments are, rather than by the planner, so each takes a single
+   sin() and cos() and the planner buffer holds the whole arc in one block.
+
+   Each chord needs stepper block data of its own. It is only taken for a chord that has steps, so
+   the stepper blocks in use never outnumber the segments.
+*/
+static uint32_t arc_chord(float mm_remaining) {
+    plan_arc_t* arc    = pl_block->arc;
+    auto        n_axis = config->_axes->_numberAxis;
+    int32_t     target[MAX_N_AXIS];
+    if (mm_remaining == 0.0f) {
+        copyAxes(target, arc->end_steps);  // Exactly where the planner expects the arc to end
+    } else {
+        float fraction = 1.0f - mm_remaining / arc->millimeters;
+        float angle    = fraction * arc->angular_travel;
+        float cos_a    = cosf(angle);
+        float sin_a    = sinf(angle);
+        float point[MAX_N_AXIS];
+        for (size_t idx = 0; idx < n_axis; idx++) {
+            point[idx] = arc->start[idx] + fraction * arc->delta[idx];
+        }
+        point[arc->axis_0] = arc->center[0] + arc->radius[0] * cos_a - arc->radius[1] * sin_a;
+        point[arc->axis_1] = arc->center[1] + arc->radius[0] * sin_a + arc->radius[1] * cos_a;
+        for (size_t idx = 0; idx < n_axis; idx++) {
+            target[idx] = mpos_to_steps(point[idx], idx);
+        }
+    }
+
+    int32_t  delta[MAX_N_AXIS];
+    uint32_t n_step = 0;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        delta[idx] = target[idx] - prep.arc_position[idx];
+        n_step     = MAX(n_step, uint32_t(labs(delta[idx])));
+    }
+    if (n_step == 0) {
+        return 0;
+    }
+    if (prep.st_block_used) {
+        bool is_pwm_rate_adjusted           = st_prep_block->is_pwm_rate_adjusted;
+        prep.st_block_index                 = next_block_index(prep.st_block_index);
+        st_prep_block                       = &st_block_buffer[prep.st_block_index];
+        st_prep_block->is_pwm_rate_adjusted = is_pwm_rate_adjusted;
+        prep.st_block_used                  = false;
+    }
+    uint8_t direction_bits = 0;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        if (delta[idx] < 0) {
+            direction_bits |= bitnum_to_mask(idx);
+        }
+        st_prep_block->steps[idx] = uint32_t(labs(delta[idx])) << maxAmassLevel;
+    }
+    st_prep_block->step_event_count = n_step << maxAmassLevel;
+    st_prep_block->direction_bits   = direction_bits;
+    copyAxes(prep.arc_position, target);
+    return n_step;
 }
 
 /* Prepares step segment buffer. Continuously called from main program.
@@ -388,24 +644,35 @@ static uint8_t next_block_index(uint8_t block_index) {
    NOTE: Computation units are in steps, millimeters, and minutes.
 */
 void Stepper::prep_buffer() {
+    Lock lock;
+
     // Block step prep buffer, while in a suspend state and there is no suspend motion to execute.
     if (sys.step_control.endMotion) {
         return;
     }
 
-    while (segment_buffer_tail != segment_next_head) {  // Check if we need to fill the buffer.
+    while (!segment_buffer.full()) {  // Check if we need to fill the buffer.
         // Determine if we need to load a new planner block or if the block needs to be recomputed.
         if (pl_block == NULL) {
             // Query planner for a queued block
             if (sys.step_control.executeSysMotion) {
-                pl_block = plan_get_system_motion_block();
+                set_prep_block(plan_get_system_motion_block());
             } else {
-                pl_block = plan_get_current_block();
+                set_prep_block(plan_get_current_block());
             }
 
             if (pl_block == NULL) {
+                if (awake) {
+                    planner_starved.store(true, std::memory_order_relaxed);
+                }
                 return;  // No planner blocks. Exit.
             }
+            if (planner_starved.exchange(false, std::memory_order_relaxed)) {
+                uint32_t pending = starved_pending.exchange(0, std::memory_order_relaxed);
+                if (awake) {
+                    stats.starved_ticks += pending;
+                }
+            }
 
             // Check if we need to only recompute the velocity profile or load a new block.
             if (prep.recalculate_flag.recalculate) {
@@ -415,6 +682,7 @@ void Stepper::prep_buffer() {
                     prep.recalculate_flag = {};
                 }
             } else {
+                ++prepped_blocks;
                 // Load the Bresenham stepping data for the block.
                 prep.st_block_index = next_block_index(prep.st_block_index);
                 // Prepare and copy Bresenham algorithm segment data from the new planner block, so that
@@ -422,6 +690,7 @@ void Stepper::prep_buffer() {
                 // segment buffer finishes the prepped block, but the stepper ISR is still executing it.
                 st_prep_block                 = &st_block_buffer[prep.st_block_index];
                 st_prep_block->direction_bits = pl_block->direction_bits;
+                prep.st_block_used            = false;
                 uint8_t idx;
                 auto    n_axis = config->_axes->_numberAxis;
 
@@ -434,8 +703,13 @@ void Stepper::prep_buffer() {
                 st_prep_block->step_event_count = pl_block->step_event_count << maxAmassLevel;
 
                 // Initialize segment buffer data for generating the segments.
-                prep.steps_remaining  = (float)pl_block->step_event_count;
-                prep.step_per_mm      = prep.steps_remaining / pl_block->millimeters;
+                prep.steps_remaining = (float)pl_block->step_event_count;
+                if (pl_block->arc) {
+                    prep.step_per_mm = pl_block->arc->step_per_mm;
+                    copyAxes(prep.arc_position, pl_block->arc->start_steps);
+                } else {
+                    prep.step_per_mm = prep.steps_remaining / pl_block->millimeters;
+                }
                 prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR / prep.step_per_mm;
                 prep.dt_remainder     = 0.0;  // Reset for new segment block
                 if ((sys.step_control.executeHold) || prep.recalculate_flag.decelOverride) {
@@ -538,16 +812,32 @@ void Stepper::prep_buffer() {
                     }
                 } else {  // Acceleration-only type
                     prep.accelerate_until = 0.0;
-                    // prep.decelerate_after = 0.0;
-                    prep.maximum_speed = prep.exit_speed;
+                    prep.decelerate_after = 0.0;
+                    prep.maximum_speed    = prep.exit_speed;
                 }
+                // A shaped deceleration that is longer than the planned one starts that much earlier
+                // in the cruise. The margin keeps rounding from making it too short to fit.
+                if (pl_block->jerk != 0.0f && prep.decelerate_after < prep.accelerate_until && prep.exit_speed < prep.maximum_speed) {
+                    float decel_mm = 1.0001f * s_curve_length(prep.maximum_speed, prep.exit_speed);
+                    if (decel_mm > prep.decelerate_after && decel_mm < prep.accelerate_until) {
+                        prep.decelerate_after = decel_mm;
+                    }
+                }
+            }
+            if (prep.ramp_type == RAMP_ACCEL) {
+                prep.accelerate_until = start_ramp(
+                    pl_block->millimeters, prep.accelerate_until, prep.maximum_speed, MIN(prep.accelerate_until, prep.decelerate_after));
+            } else if (prep.ramp_type == RAMP_DECEL) {
+                start_ramp(pl_block->millimeters, prep.mm_complete, prep.exit_speed, prep.mm_complete);
+            } else {
+                prep.s_curve = false;
             }
 
             sys.step_control.updateSpindleSpeed = true;  // Force update whenever updating block.
         }
 
         // Initialize new segment
-        volatile segment_t* prep_segment = &segment_buffer[segment_buffer_head];
+        segment_t* prep_segment = &segment_buffer.back();
 
         // Set new segment to point to the current segment data block.
         prep_segment->st_block_index = prep.st_block_index;
@@ -566,11 +856,17 @@ void Stepper::prep_buffer() {
           the end of planner block (typical) or mid-block at the end of a forced deceleration,
           such as from a feed hold.
         */
-        float dt_max   = DT_SEGMENT;                                // Maximum segment time
+        float dt_segment = DT_SEGMENT;
+        if (pl_block->arc) {
+            // Keep the chords of an arc within the arc tolerance.
+            dt_segment = MIN(dt_segment, pl_block->arc->max_chord / MAX(prep.current_speed, prep.maximum_speed));
+        }
+        float dt_max   = dt_segment;                                // Maximum segment time
         float dt       = 0.0;                                       // Initialize segment time
         float time_var = dt_max;                                    // Time worker variable
         float mm_var;                                               // mm-Distance worker variable
         float speed_var;                                            // Speed worker variable
+        bool  ramp_end;                                             // End of ramp worker flag
         float mm_remaining = pl_block->millimeters;                 // New segment distance from end of block.
         float minimum_mm   = mm_remaining - prep.req_mm_increment;  // Guarantee at least one step.
 
@@ -592,24 +888,35 @@ void Stepper::prep_buffer() {
                         prep.current_speed = prep.maximum_speed;
                     } else {  // Mid-deceleration override ramp.
                         prep.current_speed -= speed_var;
+                        prep.current_accel = -pl_block->acceleration;
                     }
                     break;
                 case RAMP_ACCEL:
                     // NOTE: Acceleration ramp only computes during first do-while loop.
-                    speed_var = pl_block->acceleration * time_var;
-                    mm_remaining -= time_var * (prep.current_speed + 0.5f * speed_var);
-                    if (mm_remaining < prep.accelerate_until) {  // End of acceleration ramp.
+                    if (prep.s_curve) {
+                        ramp_end = !s_curve_segment(time_var, prep.accelerate_until, mm_remaining);
+                    } else {
+                        speed_var = pl_block->acceleration * time_var;
+                        mm_remaining -= time_var * (prep.current_speed + 0.5f * speed_var);
+                        ramp_end = mm_remaining < prep.accelerate_until;
+                    }
+                    if (ramp_end) {  // End of acceleration ramp.
                         // Acceleration-cruise, acceleration-deceleration ramp junction, or end of block.
-                        mm_remaining = prep.accelerate_until;  // NOTE: 0.0 at EOB
-                        time_var     = 2.0f * (pl_block->millimeters - mm_remaining) / (prep.current_speed + prep.maximum_speed);
+                        mm_remaining       = prep.accelerate_until;  // NOTE: 0.0 at EOB
+                        time_var           = 2.0f * (pl_block->millimeters - mm_remaining) / (prep.current_speed + prep.maximum_speed);
+                        prep.current_speed = prep.maximum_speed;
+                        if (prep.s_curve) {
+                            prep.current_accel = 0.0f;
+                        }
                         if (mm_remaining == prep.decelerate_after) {
                             prep.ramp_type = RAMP_DECEL;
+                            start_ramp(mm_remaining, prep.mm_complete, prep.exit_speed, prep.mm_complete);
                         } else {
                             prep.ramp_type = RAMP_CRUISE;
                         }
-                        prep.current_speed = prep.maximum_speed;
-                    } else {  // Acceleration only.
+                    } else if (!prep.s_curve) {  // Acceleration only.
                         prep.current_speed += speed_var;
+                        prep.current_accel = pl_block->acceleration;
                     }
                     break;
                 case RAMP_CRUISE:
@@ -619,29 +926,42 @@ void Stepper::prep_buffer() {
                     mm_var = mm_remaining - prep.maximum_speed * time_var;
                     if (mm_var < prep.decelerate_after) {  // End of cruise.
                         // Cruise-deceleration junction or end of block.
-                        time_var       = (mm_remaining - prep.decelerate_after) / prep.maximum_speed;
-                        mm_remaining   = prep.decelerate_after;  // NOTE: 0.0 at EOB
-                        prep.ramp_type = RAMP_DECEL;
+                        time_var           = (mm_remaining - prep.decelerate_after) / prep.maximum_speed;
+                        mm_remaining       = prep.decelerate_after;  // NOTE: 0.0 at EOB
+                        prep.ramp_type     = RAMP_DECEL;
+                        prep.current_accel = 0.0f;
+                        start_ramp(mm_remaining, prep.mm_complete, prep.exit_speed, prep.mm_complete);
                     } else {  // Cruising only.
-                        mm_remaining = mm_var;
+                        mm_remaining       = mm_var;
+                        prep.current_accel = 0.0f;
                     }
                     break;
                 default:  // case RAMP_DECEL:
-                    // NOTE: mm_var used as a misc worker variable to prevent errors when near zero speed.
-                    speed_var = pl_block->acceleration * time_var;  // Used as delta speed (mm/min)
-                    if (prep.current_speed > speed_var) {           // Check if at or below zero speed.
-                        // Compute distance from end of segment to end of block.
-                        mm_var = mm_remaining - time_var * (prep.current_speed - 0.5f * speed_var);  // (mm)
-                        if (mm_var > prep.mm_complete) {                                             // Typical case. In deceleration ramp.
-                            mm_remaining = mm_var;
-                            prep.current_speed -= speed_var;
-                            break;  // Segment complete. Exit switch-case statement. Continue do-while loop.
+                    if (prep.s_curve) {
+                        if (s_curve_segment(time_var, prep.mm_complete, mm_remaining)) {
+                            break;  // Segment complete. In shaped deceleration ramp.
+                        }
+                    } else {
+                        // NOTE: mm_var used as a misc worker variable to prevent errors when near zero speed.
+                        speed_var = pl_block->acceleration * time_var;  // Used as delta speed (mm/min)
+                        if (prep.current_speed > speed_var) {           // Check if at or below zero speed.
+                            // Compute distance from end of segment to end of block.
+                            mm_var = mm_remaining - time_var * (prep.current_speed - 0.5f * speed_var);  // (mm)
+                            if (mm_var > prep.mm_complete) {  // Typical case. In deceleration ramp.
+                                mm_remaining = mm_var;
+                                prep.current_speed -= speed_var;
+                                prep.current_accel = -pl_block->acceleration;
+                                break;  // Segment complete. Exit switch-case statement. Continue do-while loop.
+                            }
                         }
                     }
                     // Otherwise, at end of block or end of forced-deceleration.
                     time_var           = 2.0f * (mm_remaining - prep.mm_complete) / (prep.current_speed + prep.exit_speed);
                     mm_remaining       = prep.mm_complete;
                     prep.current_speed = prep.exit_speed;
+                    if (prep.s_curve) {
+                        prep.current_accel = 0.0f;
+                    }
             }
 
             dt += time_var;  // Add computed ramp time to total segment time.
@@ -651,7 +971,7 @@ void Stepper::prep_buffer() {
                 if (mm_remaining > minimum_mm) {  // Check for very slow segments with zero steps.
                     // Increase segment time to ensure at least one step in segment. Override and loop
                     // through distance calculations until minimum_mm or mm_complete.
-                    dt_max += DT_SEGMENT;
+                    dt_max += dt_segment;
                     time_var = dt_max - dt;
                 } else {
                     break;  // **Complete** Exit loop. Segment execution time maxed.
@@ -694,10 +1014,18 @@ void Stepper::prep_buffer() {
            Fortunately, this scenario is highly unlikely and unrealistic in typical DIY CNC
            machines (i.e. exceeding 10 meters axis travel at 200 step/mm).
         */
-        float step_dist_remaining    = prep.step_per_mm * mm_remaining;                       // Convert mm_remaining to steps
-        float n_steps_remaining      = ceilf(step_dist_remaining);                            // Round-up current steps remaining
-        float last_n_steps_remaining = ceilf(prep.steps_remaining);                           // Round-up last steps remaining
-        prep_segment->n_step         = uint16_t(last_n_steps_remaining - n_steps_remaining);  // Compute number of steps to execute.
+        float step_dist_remaining, n_steps_remaining, last_n_steps_remaining;
+        if (pl_block->arc) {
+            // Each segment of an arc is a whole chord, with no partial step left over.
+            last_n_steps_remaining       = float(arc_chord(mm_remaining));
+            step_dist_remaining          = n_steps_remaining = 0.0f;
+            prep_segment->st_block_index = prep.st_block_index;
+        } else {
+            step_dist_remaining    = prep.step_per_mm * mm_remaining;  // Convert mm_remaining to steps
+            n_steps_remaining      = ceilf(step_dist_remaining);       // Round-up current steps remaining
+            last_n_steps_remaining = ceilf(prep.steps_remaining);      // Round-up last steps remaining
+        }
+        prep_segment->n_step = uint16_t(last_n_steps_remaining - n_steps_remaining);  // Compute number of steps to execute.
 
         // Bail if we are at the end of a feed hold and don't have a step to execute.
         if (prep_segment->n_step == 0) {
@@ -710,6 +1038,16 @@ void Stepper::prep_buffer() {
                 }
                 return;  // Segment not generated, but current step data still retained.
             }
+            if (pl_block->arc) {
+                // The chord rounds to no steps. Leave its time to the next chord.
+                prep.dt_remainder += dt;
+                pl_block->millimeters = mm_remaining;
+                if (mm_remaining == 0.0) {
+                    set_prep_block(NULL);
+                    plan_discard_current_block();
+                }
+                continue;
+            }
         }
 
         // Compute segment step rate. Since steps are integers and mm distances traveled are not,
@@ -745,14 +1083,14 @@ void Stepper::prep_buffer() {
         prep_segment->isrPeriod = timerTicks > 0xffff ? 0xffff : timerTicks;
 
         // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
-        auto lastseg        = segment_next_head;
-        segment_next_head   = segment_next_head >= (config->_stepping->_segments - 1) ? 0 : segment_next_head + 1;
-        segment_buffer_head = lastseg;
+        ++prepped_segments;
+        segment_buffer.push();
 
         // Update the appropriate planner and segment data.
         pl_block->millimeters = mm_remaining;
         prep.steps_remaining  = n_steps_remaining;
         prep.dt_remainder     = (n_steps_remaining - step_dist_remaining) * inv_rate;
+        prep.st_block_used    = true;
         // Check for exit conditions and flag to load next planner block.
         if (mm_remaining == prep.mm_complete) {
             // End of planner block or forced-termination. No more distance to be executed.
@@ -771,7 +1109,7 @@ void Stepper::prep_buffer() {
                     sys.step_control.endMotion = true;
                     return;
                 }
-                pl_block = NULL;  // Set pointer to indicate check and load next planner block.
+                set_prep_block(NULL);  // Set pointer to indicate check and load next planner block.
                 plan_discard_current_block();
             }
         }
@@ -794,3 +1132,23 @@ float Stepper::get_realtime_rate() {
             return 0.0f;
     }
 }
+
+void Stepper::reset_stats() {
+    Lock lock;
+    stats.underruns.store(0);
+    stats.min_fill.store(UINT32_MAX);
+    stats.starved_ticks = 0;
+}
+
+uint32_t Stepper::min_segment_fill() {
+    uint32_t fill = stats.min_fill;
+    return fill < segment_buffer.capacity() ? fill : segment_buffer.capacity();
+}
+
+uint32_t Stepper::segment_fill() {
+    return segment_buffer.count();
+}
+
+float Stepper::starved_seconds() {
+    return float(stats.starved_ticks) / Machine::Stepping::fStepperTimer;
+}
@@ -11,6 +11,7 @@
 
 #include "EnumItem.h"
 
+#include <atomic>
 #include <cstdint>
 
 namespace Stepper {
@@ -36,9 +37,26 @@ namespace Stepper {
     // Restores the step segment buffer to the normal run state after a parking motion.
     void parking_restore_buffer();
 
-    // Reloads step segment buffer. Called continuously by realtime execution system.
+    // Reloads step segment buffer. Called by the motion task when it is running, otherwise continuously
+    // by the realtime execution system.
     void prep_buffer();
 
+    // The planner and the segment generator are shared by the protocol loop and the motion task, which
+    // run on different cores. Holding the lock keeps the other one out. It is recursive, and the planner
+    // and stepper functions take it around the state that they share, so it is only needed explicitly
+    // to make a sequence of them, together with changes to sys.step_control, atomic.
+    void lock();
+    void unlock();
+
+    class Lock {
+    public:
+        Lock() { lock(); }
+        ~Lock() { unlock(); }
+
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
     // Called by planner_recalculate() when the executing block is updated by the new plan.
     bool update_plan_block_parameters();
 
@@ -46,4 +64,24 @@ namespace Stepper {
     float get_realtime_rate();
 
     extern uint32_t isr_count;
+
+    // Running totals of planner blocks loaded and step segments generated by prep_buffer()
+    extern uint32_t prepped_blocks;
+    extern uint32_t prepped_segments;
+
+    // Segment buffer starvation statistics, shown by $Stats and optionally in the status report.
+    // A stutter with underruns means that prep fell behind; planner starvation without underruns
+    // means that the sender fell behind, but the segment buffer covered for it.
+    // The ISR updates the counters, so they are atomic; starved_ticks is only changed under Lock.
+    struct Stats {
+        std::atomic<uint32_t> underruns;      // Times the segment buffer ran empty while prep still had steps for it
+        std::atomic<uint32_t> min_fill;       // Fewest queued segments seen while prep still had steps for them
+        uint64_t              starved_ticks;  // Step timer ticks executed with an empty planner buffer, mid-motion
+    };
+    extern Stats stats;
+
+    void     reset_stats();
+    uint32_t min_segment_fill();  // stats.min_fill, or the segment buffer size if nothing was seen
+    uint32_t segment_fill();      // Segments queued for the stepping ISR right now
+    float    starved_seconds();
 }
@@ -0,0 +1,127 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Telemetry.h"
+
+#include "Channel.h"
+#include "Logging.h"
+#include "Machine/MachineConfig.h"  // config
+#include "Planner.h"                // plan_get_current_block, plan_get_block_buffer_available
+#include "Stepper.h"                // Stepper::get_realtime_rate, Stepper::segment_fill
+#include "System.h"                 // sys, get_motor_steps
+
+#include <cmath>
+#include <cstring>
+
+namespace Telemetry {
+    namespace {
+        uint8_t clampByte(uint32_t value) {
+            return value < 255 ? value : 255;
+        }
+    }
+
+    void Encoder::enable(bool on) {
+        _enabled = on;
+        _key     = true;
+    }
+
+    size_t Encoder::encode(uint8_t* data) {
+        bool key = _key || _sinceKey >= keyInterval;
+
+        auto     n_axis = config->_axes->_numberAxis;
+        int32_t* steps  = get_motor_steps();
+
+        uint32_t line = 0;
+        if (config->_useLineNumbers) {
+            plan_block_t* block = plan_get_current_block();
+            if (block) {
+                line = block->line_number;
+            }
+        }
+
+        float rate = Stepper::get_realtime_rate();
+        if (config->_reportInches) {
+            rate /= MM_PER_INCH;
+        }
+        uint32_t feed    = uint32_t(lroundf(rate));
+        uint32_t spindle = sys.spindle_speed;
+
+        uint8_t buffers[2]   = { plan_get_block_buffer_available(), clampByte(Stepper::segment_fill()) };
+        uint8_t overrides[3] = { sys.f_override, sys.r_override, sys.spindle_speed_ovr };
+
+        uint8_t fields = Steps | Line | Feed | Spindle | Buffers | Overrides;
+        if (!key) {
+            if (!memcmp(_steps, steps, n_axis * sizeof(int32_t))) {
+                fields &= ~Steps;
+            }
+            if (line == _line) {
+                fields &= ~Line;
+            }
+            if (feed == _feed) {
+                fields &= ~Feed;
+            }
+            if (spindle == _spindle) {
+                fields &= ~Spindle;
+            }
+            if (!memcmp(buffers, _buffers, sizeof(buffers))) {
+                fields &= ~Buffers;
+            }
+            if (!memcmp(overrides, _overrides, sizeof(overrides))) {
+                fields &= ~Overrides;
+            }
+        }
+
+        uint8_t* out = data;
+        *out++       = (key ? keyFrame : 0) | (_sequence & 0x7f);
+        *out++       = uint8_t(sys.state);
+        *out++       = fields;
+        if (fields & Steps) {
+            if (key) {
+                *out++ = n_axis;
+            }
+            for (int axis = 0; axis < n_axis; axis++) {
+                out          = putSigned(key ? steps[axis] : steps[axis] - _steps[axis], out);
+                _steps[axis] = steps[axis];
+            }
+        }
+        if (fields & Line) {
+            out = putVarint(line, out);
+        }
+        if (fields & Feed) {
+            out = putVarint(feed, out);
+        }
+        if (fields & Spindle) {
+            out = putVarint(spindle, out);
+        }
+        if (fields & Buffers) {
+            memcpy(out, buffers, sizeof(buffers));
+            out += sizeof(buffers);
+        }
+        if (fields & Overrides) {
+            memcpy(out, overrides, sizeof(overrides));
+            out += sizeof(overrides);
+        }
+
+        _line    = line;
+        _feed    = feed;
+        _spindle = spindle;
+        memcpy(_buffers, buffers, sizeof(buffers));
+        memcpy(_overrides, overrides, sizeof(overrides));
+
+        ++_sequence;
+        _sinceKey = key ? 1 : _sinceKey + 1;
+        _key      = false;
+        return out - data;
+    }
+
+    void Encoder::report(Channel& out) {
+        uint8_t frame[maxFrame];
+        char    text[4 * ((maxFrame + 2) / 3) + 1];
+
+        text[base64(frame, encode(frame), text)] = '\0';
+
+        LogStream msg(out, "[TLM:");
+        msg << text;
+        // The destructor adds the ] and sends the line
+    }
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Telemetry frames are a compact alternative to the text status report, for
+// hosts that poll the machine at high rates.  A channel that has telemetry
+// turned on with $Report/Telemetry=ON sends a frame instead of a <...> status
+// report each time auto reporting would send one, and $Report/Interval can
+// then be as short as minInterval.  ? still gets a text status report.
+//
+// A frame is binary, but it is sent as a [TLM:...] line with the bytes in
+// base64, so that it passes through every channel - including the ones that
+// translate line endings - and stays in order with the other output.  Senders
+// that do not know about it ignore it like any other [...] message.
+//
+// The frame bytes are:
+//
+//   header    bit 7 set for a key frame, bits 0-6 a sequence number that
+//             counts frames modulo 128
+//   state     the State enum value
+//   fields    a mask of the fields that follow, in this order:
+//     Steps     the axis count as a byte in a key frame, then one signed
+//               varint per axis with the motor position in steps - the
+//               change since the last frame, or the position in a key frame
+//     Line      unsigned varint, the line number of the running block
+//     Feed      unsigned varint, the feed rate in the FS: units of the report
+//     Spindle   unsigned varint, the spindle speed
+//     Buffers   two bytes, the free planner blocks and the queued step segments
+//     Overrides three bytes, the feed, rapid and spindle overrides in percent
+//
+// Varints are little-endian base-128, as in protobuf, and signed values are
+// zigzag encoded.  A key frame has every field.  Other frames have only the
+// fields that changed, so a host must apply the frames in order; if the
+// sequence number skips, it should ignore frames until the next key frame.
+// Key frames are sent every keyInterval frames and whenever telemetry is
+// turned on.
+
+#include "Config.h"          // MAX_N_AXIS
+#include "TelemetryCodec.h"  // maxVarint
+
+#include <cstddef>
+#include <cstdint>
+
+class Channel;
+
+namespace Telemetry {
+    const uint32_t minInterval = 1;   // ms
+    const uint8_t  keyInterval = 64;  // frames
+
+    const uint8_t keyFrame = 0x80;
+
+    enum Field : uint8_t {
+        Steps     = 0x01,
+        Line      = 0x02,
+        Feed      = 0x04,
+        Spindle   = 0x08,
+        Buffers   = 0x10,
+        Overrides = 0x20,
+    };
+
+    // The most bytes in a frame, before base64
+    const size_t maxFrame = 3 + 1 + MAX_N_AXIS * maxVarint + 3 * maxVarint + 2 + 3;
+
+    // Builds the frames for one channel, from the values in its last frame
+    class Encoder {
+        bool     _enabled  = false;
+        bool     _key      = true;
+        uint8_t  _sequence = 0;
+        uint8_t  _sinceKey = 0;
+        int32_t  _steps[MAX_N_AXIS];
+        uint32_t _line;
+        uint32_t _feed;
+        uint32_t _spindle;
+        uint8_t  _buffers[2];
+        uint8_t  _overrides[3];
+
+    public:
+        bool enabled() { return _enabled; }
+        void enable(bool on);
+
+        // Writes the next frame to data, which must hold maxFrame bytes, and returns its length
+        size_t encode(uint8_t* data);
+
+        // Sends the next frame to the channel
+        void report(Channel& out);
+    };
+}
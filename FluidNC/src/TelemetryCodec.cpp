@@ -0,0 +1,40 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "TelemetryCodec.h"
+
+namespace Telemetry {
+    uint8_t* putVarint(uint32_t value, uint8_t* out) {
+        while (value >= 0x80) {
+            *out++ = uint8_t(value) | 0x80;
+            value >>= 7;
+        }
+        *out++ = uint8_t(value);
+        return out;
+    }
+
+    uint8_t* putSigned(int32_t value, uint8_t* out) {
+        return putVarint((uint32_t(value) << 1) ^ uint32_t(value >> 31), out);
+    }
+
+    size_t base64(const uint8_t* data, size_t length, char* out) {
+        static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        char* p = out;
+        for (; length >= 3; length -= 3, data += 3) {
+            uint32_t bits = (data[0] << 16) | (data[1] << 8) | data[2];
+            *p++          = digits[bits >> 18];
+            *p++          = digits[(bits >> 12) & 0x3f];
+            *p++          = digits[(bits >> 6) & 0x3f];
+            *p++          = digits[bits & 0x3f];
+        }
+        if (length) {
+            uint32_t bits = (data[0] << 16) | (length > 1 ? data[1] << 8 : 0);
+            *p++          = digits[bits >> 18];
+            *p++          = digits[(bits >> 12) & 0x3f];
+            *p++          = length > 1 ? digits[(bits >> 6) & 0x3f] : '=';
+            *p++          = '=';
+        }
+        return p - out;
+    }
+}
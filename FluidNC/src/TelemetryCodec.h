@@ -0,0 +1,25 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// The byte encodings of telemetry frames.  See Telemetry.h for the frame layout.
+// They do not depend on the machine config, so the unit tests build them too.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Telemetry {
+    // The most bytes in a varint of a 32-bit value
+    const size_t maxVarint = 5;
+
+    // Writes value as a little-endian base-128 varint, and returns the byte after it
+    uint8_t* putVarint(uint32_t value, uint8_t* out);
+
+    // Writes value zigzag encoded as a varint, and returns the byte after it
+    uint8_t* putSigned(int32_t value, uint8_t* out);
+
+    // Writes the base64 encoding of data to out, which must hold 4 * ((length + 2) / 3) characters,
+    // and returns the number of characters
+    size_t base64(const uint8_t* data, size_t length, char* out);
+}
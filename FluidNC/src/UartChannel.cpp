@@ -73,7 +73,8 @@ int UartChannel::peek() {
 }
 
 int UartChannel::rx_buffer_available() {
-    return _uart->rx_buffer_available();
+    // Characters that pollLine() moves out of the UART wait in the receive ring
+    return _uart->rx_buffer_available() + Channel::rx_buffer_available();
 }
 
 bool UartChannel::realtimeOkay(char c) {
@@ -104,11 +105,9 @@ size_t UartChannel::timedReadBytes(char* buffer, size_t length, TickType_t timeo
     // It is likely that _queue will be empty because timedReadBytes() is only
     // used in situations where the UART is not receiving GCode commands
     // and Grbl realtime characters.
-    size_t remlen = length;
-    while (remlen && _queue.size()) {
-        *buffer++ = _queue.front();
-        _queue.pop();
-    }
+    size_t queued = _queue.read(reinterpret_cast<uint8_t*>(buffer), length);
+    buffer += queued;
+    size_t remlen = length - queued;
 
     int res = _uart->timedReadBytes(buffer, remlen, timeout);
     // If res < 0, no bytes were read
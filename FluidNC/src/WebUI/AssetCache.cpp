@@ -0,0 +1,94 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "AssetCache.h"
+
+#ifdef ENABLE_WIFI
+
+#    include "../FileStream.h"
+#    include "../HashFS.h"
+#    include "../Logging.h"
+
+#    include <esp_heap_caps.h>
+
+namespace WebUI {
+    std::map<std::string, AssetCache::Asset> AssetCache::_assets;
+    size_t                                   AssetCache::_bytes = 0;
+
+    bool AssetCache::available() {
+        static const bool psram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) != 0;
+        return psram;
+    }
+
+    void AssetCache::drop(std::map<std::string, Asset>::iterator it) {
+        _bytes -= it->second.size;
+        heap_caps_free(it->second.data);
+        _assets.erase(it);
+    }
+
+    const AssetCache::Asset* AssetCache::find(const std::filesystem::path& path) {
+        auto it = _assets.find(path.string());
+        if (it == _assets.end()) {
+            return nullptr;
+        }
+        std::filesystem::path file(path);
+        if (it->second.gzip) {
+            file += ".gz";
+        }
+        if (HashFS::hash(file) != it->second.etag) {
+            log_debug(path << " changed; dropping it from the cache");
+            drop(it);
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    const AssetCache::Asset* AssetCache::add(const std::filesystem::path& path) {
+        std::filesystem::path file(path);
+        bool                  gzip = false;
+        std::string           etag = HashFS::hash(file);
+        if (!etag.length()) {
+            file += ".gz";
+            gzip = true;
+            etag = HashFS::hash(file);
+            if (!etag.length()) {
+                return nullptr;  // Not in the root of the local filesystem
+            }
+        }
+
+        auto it = _assets.find(path.string());
+        if (it != _assets.end()) {
+            drop(it);
+        }
+
+        try {
+            FileStream inFile { file, "r" };
+            size_t     size = inFile.size();
+            if (_bytes + size > budget) {
+                log_debug(file.filename() << " does not fit in the cache");
+                return nullptr;
+            }
+            uint8_t* data = static_cast<uint8_t*>(heap_caps_malloc(size ? size : 1, MALLOC_CAP_SPIRAM));
+            if (!data) {
+                return nullptr;  // No PSRAM
+            }
+            if (inFile.read(data, size) != size) {
+                log_debug("Cannot read " << file);
+                heap_caps_free(data);
+                return nullptr;
+            }
+            _bytes += size;
+            return &(_assets[path.string()] = { data, size, gzip, etag });
+        } catch (const Error err) {
+            return nullptr;
+        }
+    }
+
+    void AssetCache::clear() {
+        while (!_assets.empty()) {
+            drop(_assets.begin());
+        }
+    }
+}
+
+#endif
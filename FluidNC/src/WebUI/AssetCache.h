@@ -0,0 +1,67 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// The WebUI files from the root of the local filesystem, held in PSRAM so
+// that they can be served without touching the flash.  Each file is kept with
+// the HashFS hash that it had when it was loaded, which is its ETag.  A file
+// that has changed since then no longer matches its hash, so it is dropped
+// when it is next looked up, and can then be loaded again.
+//
+// Serving from flash takes so many cycles that it is refused during motion.
+// Serving from the cache is just a socket write, but the write blocks the
+// poller task, which also feeds G-code lines to the main loop, until the
+// data is sent.  So during motion only assets up to maxMotionSize, which
+// fit in the TCP send buffers, are served from the cache.
+
+#include "../Config.h"  // ENABLE_*
+
+#ifdef ENABLE_WIFI
+
+#    include <cstddef>
+#    include <cstdint>
+#    include <filesystem>
+#    include <map>
+#    include <string>
+
+namespace WebUI {
+    class AssetCache {
+    public:
+        struct Asset {
+            uint8_t*    data;
+            size_t      size;
+            bool        gzip;  // The data came from path.gz
+            std::string etag;
+        };
+
+        // The most PSRAM that the cache will use
+        static const size_t budget = 1024 * 1024;
+
+        // The largest asset that is served during motion
+        static const size_t maxMotionSize = 8 * 1024;
+
+        // Returns true if there is PSRAM to hold the cache.  Without it, nothing
+        // is cached and the callers should not try.
+        static bool available();
+
+        // Returns the asset for a local filesystem path, or nullptr if it is not
+        // cached or has changed since it was cached
+        static const Asset* find(const std::filesystem::path& path);
+
+        // Reads path, or path.gz if path does not exist, into the cache, and returns
+        // the asset, or nullptr if there is no such file, or no PSRAM for it
+        static const Asset* add(const std::filesystem::path& path);
+
+        static void   clear();
+        static size_t bytes() { return _bytes; }
+
+    private:
+        static std::map<std::string, Asset> _assets;  // By path, without .gz
+        static size_t                       _bytes;
+
+        static void drop(std::map<std::string, Asset>::iterator it);
+    };
+}
+
+#endif
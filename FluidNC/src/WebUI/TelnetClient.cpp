@@ -60,7 +60,15 @@ namespace WebUI {
 
     int TelnetClient::available() { return _wifiClient->available(); }
 
-    int TelnetClient::rx_buffer_available() { return WIFI_CLIENT_READ_BUFFER_SIZE - available(); }
+    // TCP flow control keeps a sender from overrunning the WiFiClient buffer, so a larger
+    // receive window only lets the sender run further ahead.
+    int TelnetClient::rx_buffer_available() {
+        int window = getRxWindow();
+        if (window < WIFI_CLIENT_READ_BUFFER_SIZE) {
+            window = WIFI_CLIENT_READ_BUFFER_SIZE;
+        }
+        return window - available() - int(_queue.count());
+    }
 
     int TelnetClient::read(void) {
         if (_state == -1) {
@@ -66,6 +66,10 @@ namespace WebUI {
         print_msg(level, line->c_str());
         delete line;
     }
+    void WebClient::sendLine(MsgLevel level, LogLine* line) {
+        print_msg(level, line->text);
+        LogLine::release(line);
+    }
     void WebClient::sendLine(MsgLevel level, const std::string& line) { print_msg(level, line.c_str()); }
 
     void WebClient::out(const char* s, const char* tag) { write((uint8_t*)s, strlen(s)); }
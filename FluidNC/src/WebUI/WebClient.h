@@ -24,6 +24,7 @@ namespace WebUI {
 
         void sendLine(MsgLevel level, const char* line) override;
         void sendLine(MsgLevel level, const std::string* line) override;
+        void sendLine(MsgLevel level, LogLine* line) override;
         void sendLine(MsgLevel level, const std::string& line) override;
 
         void sendError(int code, const std::string& line);
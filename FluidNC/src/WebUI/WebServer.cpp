@@ -34,6 +34,7 @@
 #    include "src/WebUI/JSONEncoder.h"
 
 #    include "src/HashFS.h"
+#    include "AssetCache.h"
 #    include <list>
 
 namespace WebUI {
@@ -71,9 +72,12 @@ namespace WebUI {
     uint8_t           Web_Server::_nb_ip = 0;
     const int         MAX_AUTH_IP        = 10;
 #    endif
-    FileStream* Web_Server::_uploadFile = nullptr;
+    FileStream*     Web_Server::_uploadFile   = nullptr;
+    HashFS::Hasher* Web_Server::_uploadHasher = nullptr;
+    WriteBehind*    Web_Server::_uploadWriter = nullptr;
+    uint32_t        Web_Server::_uploadStartMs;
 
-    EnumSetting *http_enable, *http_block_during_motion;
+    EnumSetting *http_enable, *http_block_during_motion, *http_cache_assets;
     IntSetting*  http_port;
 
     Web_Server::Web_Server() {
@@ -86,6 +90,13 @@ namespace WebUI {
                                                    "HTTP/BlockDuringMotion",
                                                    DEFAULT_HTTP_BLOCKED_DURING_MOTION,
                                                    &onoffOptions);
+        http_cache_assets = new EnumSetting("Cache WebUI files in PSRAM",
+                                            WEBSET,
+                                            WA,
+                                            "",
+                                            "HTTP/CacheAssets",
+                                            AssetCache::available() ? DEFAULT_HTTP_CACHE_ASSETS : 0,
+                                            &onoffOptions);
     }
     Web_Server::~Web_Server() { end(); }
 
@@ -194,14 +205,54 @@ namespace WebUI {
         }
 
         HashFS::hash_all();
+        loadAssetCache();
 
         _setupdone = true;
         return no_error;
     }
 
+    // WebUI files are the ones with web content types, and their .gz versions
+    bool Web_Server::isWebAsset(const std::string& name) {
+        std::string plain(name);
+        if (plain.length() > 3 && !plain.compare(plain.length() - 3, 3, ".gz")) {
+            plain.resize(plain.length() - 3);
+        }
+        const char* type = getContentType(plain.c_str());
+        return !strncmp(type, "text/", 5) || !strncmp(type, "image/", 6) || !strcmp(type, "application/javascript");
+    }
+
+    // Loads the WebUI files from the root of the local filesystem into the cache
+    void Web_Server::loadAssetCache() {
+        AssetCache::clear();
+        if (!http_cache_assets->get() || !AssetCache::available()) {
+            return;
+        }
+        std::error_code ec;
+        FluidPath       lfspath { "", localfsName, ec };
+        if (ec) {
+            return;
+        }
+        for (auto const& [name, hash] : HashFS::localFsHashes) {
+            if (isWebAsset(name)) {
+                std::filesystem::path path = lfspath / name;
+                if (path.extension() == ".gz") {
+                    path.replace_extension();
+                }
+                if (!AssetCache::find(path)) {
+                    AssetCache::add(path);
+                }
+            }
+        }
+        if (AssetCache::bytes()) {
+            log_info("WebUI cache holds " << AssetCache::bytes() << " bytes");
+        }
+    }
+
     void Web_Server::end() {
         _setupdone = false;
 
+        AssetCache::clear();
+
         SSDP.end();
 
         //remove mDNS
@@ -255,6 +306,31 @@ namespace WebUI {
             _webserver->send(304);
             return true;
         }
+
+        // A cached file is served from RAM, which is cheap enough to do during motion if it is
+        // small; see AssetCache.h.  A file that is not cached yet is loaded into the cache when
+        // motion would not be disturbed.
+        if (http_cache_assets->get() && AssetCache::available() && isWebAsset(fpath.filename())) {
+            bool                     moving = inMotionState();
+            const AssetCache::Asset* asset  = AssetCache::find(fpath);
+            if (!asset && !moving) {
+                asset = AssetCache::add(fpath);
+            }
+            if (asset && (!moving || asset->size <= AssetCache::maxMotionSize)) {
+                if (download) {
+                    _webserver->sendHeader("Content-Disposition", "attachment");
+                }
+                _webserver->sendHeader("ETag", asset->etag.c_str());
+                _webserver->setContentLength(asset->size);
+                if (asset->gzip) {
+                    _webserver->sendHeader("Content-Encoding", "gzip");
+                }
+                _webserver->send(200, getContentType(path), "");
+                _webserver->client().write(asset->data, asset->size);
+                return true;
+            }
+        }
+
         // If you load or reload WebUI while a program is running, there is a high
         // risk of stalling the motion because serving a file from
         // the local FLASH filesystem takes away a lot of CPU cycles.  If we get
@@ -1046,7 +1122,13 @@ namespace WebUI {
             //Create file for writing
             try {
                 _uploadFile    = new FileStream(fpath, "w");
+                _uploadWriter  = new WriteBehind(_uploadFile);
+                _uploadStartMs = millis();
                 _upload_status = UploadStatus::ONGOING;
+                dropHasher();
+                if (HashFS::file_is_hashed(fpath)) {
+                    _uploadHasher = new HashFS::Hasher();
+                }
             } catch (const Error err) {
                 _uploadFile    = nullptr;
                 _upload_status = UploadStatus::FAILED;
@@ -1057,13 +1139,14 @@ namespace WebUI {
     }
 
     void Web_Server::uploadWrite(uint8_t* buffer, size_t length) {
-        vTaskDelay(1 / portTICK_RATE_MS);
-        if (_uploadFile && _upload_status == UploadStatus::ONGOING) {
-            //no error write post data
-            if (length != _uploadFile->write(buffer, length)) {
+        if (_uploadWriter && _upload_status == UploadStatus::ONGOING) {
+            // The writer task puts the data in the file; this only waits if it falls behind
+            if (!_uploadWriter->write(buffer, length)) {
                 _upload_status = UploadStatus::FAILED;
                 log_info("Upload failed - file write failed");
                 pushError(ESP_ERROR_FILE_WRITE, "File write failed");
+            } else if (_uploadHasher) {
+                _uploadHasher->update(buffer, length);
             }
         } else {  //if error set flag UploadStatus::FAILED
             _upload_status = UploadStatus::FAILED;
@@ -1078,6 +1161,10 @@ namespace WebUI {
             //            delete _uploadFile;
             // _uploadFile = nullptr;
 
+            if (!finishWriter(true)) {
+                _upload_status = UploadStatus::FAILED;
+                pushError(ESP_ERROR_FILE_WRITE, "File write failed");
+            }
             std::string pathname = _uploadFile->fpath();
             delete _uploadFile;
             _uploadFile = nullptr;
@@ -1085,7 +1172,13 @@ namespace WebUI {
 
             FluidPath filepath { pathname, "" };
 
-            HashFS::rehash_file(filepath);
+            // The hasher has seen every byte of a complete upload, so the file need not be read back
+            if (_uploadHasher && _upload_status == UploadStatus::ONGOING) {
+                HashFS::set_hash(filepath, _uploadHasher->finish());
+            } else {
+                HashFS::rehash_file(filepath);
+            }
+            dropHasher();
 
             // Check size
             if (filesize) {
@@ -1116,23 +1209,48 @@ namespace WebUI {
         _upload_status = UploadStatus::FAILED;
         log_info("Upload cancelled");
         if (_uploadFile) {
+            finishWriter(false);
             std::filesystem::path filepath = _uploadFile->fpath();
             delete _uploadFile;
             _uploadFile = nullptr;
             HashFS::rehash_file(filepath);
         }
+        dropHasher();
     }
     void Web_Server::uploadCheck() {
         std::error_code error_code;
         if (_upload_status == UploadStatus::FAILED) {
             cancelUpload();
             if (_uploadFile) {
+                finishWriter(false);
                 std::filesystem::path filepath = _uploadFile->fpath();
                 delete _uploadFile;
                 _uploadFile = nullptr;
                 stdfs::remove(filepath, error_code);
                 HashFS::rehash_file(filepath);
             }
+            dropHasher();
+        }
+    }
+    // Waits for the buffered data to be written, and logs the upload rate if report is set
+    bool Web_Server::finishWriter(bool report) {
+        if (!_uploadWriter) {
+            return true;
+        }
+        bool     ok      = _uploadWriter->finish();
+        uint32_t elapsed = millis() - _uploadStartMs;
+        if (ok && report) {
+            size_t bytes = _uploadWriter->bytes();
+            log_info("Uploaded " << bytes << " bytes in " << elapsed << " ms, " << (elapsed ? bytes / elapsed : bytes) << " KB/s");
+        }
+        delete _uploadWriter;
+        _uploadWriter = nullptr;
+        return ok;
+    }
+    void Web_Server::dropHasher() {
+        if (_uploadHasher) {
+            delete _uploadHasher;
+            _uploadHasher = nullptr;
         }
     }
 
@@ -11,6 +11,8 @@
 #    include "../Settings.h"
 #    include "Authentication.h"  // AuthenticationLevel
 #    include "Commands.h"
+#    include "../HashFS.h"
+#    include "../WriteBehind.h"
 
 class WebSocketsServer;
 class WebServer;
@@ -18,6 +20,7 @@ class WebServer;
 namespace WebUI {
     static const int DEFAULT_HTTP_STATE                 = 1;
     static const int DEFAULT_HTTP_BLOCKED_DURING_MOTION = 1;
+    static const int DEFAULT_HTTP_CACHE_ASSETS          = 1;  // When there is PSRAM
     static const int DEFAULT_HTTP_PORT                  = 80;
 
     static const int MIN_HTTP_PORT = 1;
@@ -61,6 +64,9 @@ namespace WebUI {
         static uint16_t          _port;
         static UploadStatus      _upload_status;
         static FileStream*       _uploadFile;
+        static HashFS::Hasher*   _uploadHasher;  // Hashes a local filesystem upload as it is written
+        static WriteBehind*      _uploadWriter;
+        static uint32_t          _uploadStartMs;
 
         static const char* getContentType(const char* filename);
 
@@ -91,6 +97,8 @@ namespace WebUI {
         static void WebUpdateUpload();
 
         static bool myStreamFile(const char* path, bool download = false);
+        static bool isWebAsset(const std::string& name);
+        static void loadAssetCache();
 
         static void pushError(int code, const char* st, bool web_error = 500, uint16_t timeout = 1000);
 
@@ -104,6 +112,8 @@ namespace WebUI {
         static void uploadEnd(size_t filesize);
         static void uploadStop();
         static void uploadCheck();
+        static void dropHasher();
+        static bool finishWriter(bool report);
 
         static void synchronousCommand(const char* cmd, bool silent, AuthenticationLevel auth_level);
         static void websocketCommand(const char* cmd, int pageid, AuthenticationLevel auth_level);
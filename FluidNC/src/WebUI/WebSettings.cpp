@@ -16,6 +16,7 @@
 #include "../Uart.h"       // Uart0.baud
 #include "../Report.h"     // git_info
 #include "../InputFile.h"  // InputFile
+#include "../Stepper.h"    // Stepper::reset_stats()
 
 #include "Commands.h"  // COMMANDS::restart_MCU();
 #include "WifiConfig.h"
@@ -44,12 +45,12 @@ namespace WebUI {
     } keyval_t;
 
     bool get_param(const char* parameter, const char* key, std::string& s) {
-        char* start = strstr(parameter, key);
+        const char* start = strstr(parameter, key);
         if (!start) {
             return false;
         }
         s = "";
-        for (char* p = start + strlen(key); *p; ++p) {
+        for (const char* p = start + strlen(key); *p; ++p) {
             if (*p == ' ') {
                 break;  // Unescaped space
             }
@@ -382,7 +383,8 @@ namespace WebUI {
         return Error::Ok;
     }
 
-    static Error openFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out, InputFile*& theFile) {
+    static Error openFile(
+        const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out, InputFile*& theFile, bool readAhead = false) {
         if (*parameter == '\0') {
             log_string(out, "Missing file name!");
             return Error::InvalidValue;
@@ -393,7 +395,7 @@ namespace WebUI {
         }
 
         try {
-            theFile = new InputFile(fs, path.c_str(), auth_level, out);
+            theFile = new InputFile(fs, path.c_str(), auth_level, out, readAhead);
         } catch (Error err) { return err; }
         return Error::Ok;
     }
@@ -407,7 +409,7 @@ namespace WebUI {
         if ((err = openFile(fs, parameter, auth_level, out, theFile)) != Error::Ok) {
             return err;
         }
-        char  fileLine[255];
+        char  fileLine[256];
         Error res;
         while ((res = theFile->readLine(fileLine, 255)) == Error::Ok) {
             // We cannot use the 2-argument form of log_stream() here because
@@ -492,7 +494,7 @@ namespace WebUI {
         if ((err = openFile(sdName, fn.c_str(), auth_level, out, theFile)) != Error::Ok) {
             error = "Cannot open file";
         } else {
-            char  fileLine[255];
+            char  fileLine[256];
             Error res;
             for (int linenum = 0; linenum < lastline && (res = theFile->readLine(fileLine, 255)) == Error::Ok; ++linenum) {
                 if (linenum >= firstline) {
@@ -516,7 +518,8 @@ namespace WebUI {
         return Error::Ok;
     }
 
-    static Error runFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    // A job reads its file ahead; a $LocalFS/Run, often from a macro, is short enough not to
+    static Error runFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out, bool readAhead) {
         Error err;
         if (sys.state == State::Alarm || sys.state == State::ConfigAlarm) {
             log_string(out, "Alarm");
@@ -527,22 +530,23 @@ namespace WebUI {
             return Error::IdleError;
         }
         InputFile* theFile;
-        if ((err = openFile(fs, parameter, auth_level, out, theFile)) != Error::Ok) {
+        if ((err = openFile(fs, parameter, auth_level, out, theFile, readAhead)) != Error::Ok) {
             return err;
         }
         allChannels.registration(theFile);
+        Stepper::reset_stats();  // The starvation statistics are per job
 
         //report_realtime_status(out);
         return Error::Ok;
     }
 
     static Error runSDFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // ESP220
-        return runFile("sd", parameter, auth_level, out);
+        return runFile("sd", parameter, auth_level, out, true);
     }
 
     // Used by js/controls.js
     static Error runLocalFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {  // ESP700
-        return runFile("", parameter, auth_level, out);
+        return runFile("", parameter, auth_level, out, false);
     }
 
     static Error deleteObject(const char* fs, const char* name, Channel& out) {
@@ -755,7 +759,7 @@ namespace WebUI {
         if (!parameter || *parameter == '\0') {
             return Error::InvalidValue;
         }
-        auto opath = strchr(parameter, '>');
+        auto opath = const_cast<char*>(strchr(parameter, '>'));
         if (*opath == '\0') {
             return Error::InvalidValue;
         }
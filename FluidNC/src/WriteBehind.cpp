@@ -0,0 +1,127 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "WriteBehind.h"
+
+#include "Config.h"  // SUPPORT_TASK_CORE
+#include "Logging.h"
+
+#include <freertos/task.h>
+
+#include <cstring>
+#include <new>
+
+// The writer task writes the full buffers of all WriteBehinds in the order
+// they are submitted.  Its priority is below the motion task and the reader
+// task, so a file job keeps running while an upload is written.
+struct WriteRequest {
+    WriteBehind* owner;
+    uint8_t*     buffer;
+    size_t       length;
+};
+
+static QueueHandle_t writeQueue = nullptr;
+static TaskHandle_t  writerTask = nullptr;
+
+static void writer_loop(void* unused) {
+    WriteRequest request;
+    while (true) {
+        if (xQueueReceive(writeQueue, &request, portMAX_DELAY)) {
+            request.owner->drain(request.buffer, request.length);
+        }
+    }
+}
+
+WriteBehind::WriteBehind(FileStream* file) : _file(file), _failed(false) {
+    if (!writerTask) {
+        writeQueue = xQueueCreate(2 * nBuffers + 1, sizeof(WriteRequest));
+        xTaskCreatePinnedToCore(writer_loop,       // task
+                                "writer",          // name for task
+                                4096,              // size of task stack
+                                0,                 // parameters
+                                1,                 // priority
+                                &writerTask,       // task handle
+                                SUPPORT_TASK_CORE  // core
+        );
+    }
+    // A malloc'ed buffer is word aligned, which is all that the SD DMA needs
+    _free = xQueueCreate(nBuffers + 1, sizeof(uint8_t*));
+    for (; _nBuffers < nBuffers; ++_nBuffers) {
+        uint8_t* buffer = new (std::nothrow) uint8_t[bufferSize];
+        if (!buffer) {
+            log_debug("Write behind has " << _nBuffers << " buffers");
+            break;
+        }
+        xQueueSend(_free, &buffer, 0);
+    }
+}
+
+WriteBehind::~WriteBehind() {
+    finish();
+    vQueueDelete(_free);
+}
+
+void WriteBehind::submit() {
+    WriteRequest request = { this, _current, _fill };
+    xQueueSend(writeQueue, &request, portMAX_DELAY);
+    _current = nullptr;
+    _fill    = 0;
+}
+
+void WriteBehind::drain(uint8_t* buffer, size_t length) {
+    if (!_failed.load(std::memory_order_relaxed) && _file->write(buffer, length) != length) {
+        _failed.store(true, std::memory_order_relaxed);
+    }
+    xQueueSend(_free, &buffer, portMAX_DELAY);
+}
+
+bool WriteBehind::write(const uint8_t* data, size_t length) {
+    if (_done) {
+        return false;
+    }
+    if (!_nBuffers) {
+        if (!_failed.load(std::memory_order_relaxed) && _file->write(data, length) != length) {
+            _failed.store(true, std::memory_order_relaxed);
+        }
+        _bytes += length;
+        return !_failed.load(std::memory_order_relaxed);
+    }
+    while (length && !_failed.load(std::memory_order_relaxed)) {
+        if (!_current) {
+            // This is the backpressure; it waits only when every buffer is being written
+            xQueueReceive(_free, &_current, portMAX_DELAY);
+        }
+        size_t n = bufferSize - _fill;
+        if (n > length) {
+            n = length;
+        }
+        memcpy(_current + _fill, data, n);
+        _fill += n;
+        _bytes += n;
+        data += n;
+        length -= n;
+        if (_fill == bufferSize) {
+            submit();
+        }
+    }
+    return !_failed.load(std::memory_order_relaxed);
+}
+
+bool WriteBehind::finish() {
+    if (!_done) {
+        _done = true;
+        if (_fill) {
+            submit();
+        } else if (_current) {
+            xQueueSend(_free, &_current, 0);
+            _current = nullptr;
+        }
+        // Every buffer comes back once it has been written
+        for (int i = 0; i < _nBuffers; ++i) {
+            uint8_t* buffer;
+            xQueueReceive(_free, &buffer, portMAX_DELAY);
+            delete[] buffer;
+        }
+    }
+    return !_failed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// WriteBehind collects the data that is written to a file into large buffers,
+// and a background writer task writes the full buffers to the file while more
+// data is collected.  The caller only waits when every buffer is full, so a
+// slow SD card write holds up the writer task instead of the task that is
+// receiving the data - for uploads, that is the poller, which also feeds the
+// planner.
+//
+// The buffers are a multiple of the SD sector size, and the file is written
+// from its start, so every full buffer is written as whole sectors.  If the
+// heap cannot hold all of the buffers, fewer are used, and with none the data
+// is written to the file directly.
+
+#include "FileStream.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class WriteBehind {
+public:
+    static const size_t bufferSize = 8192;  // 16 sectors
+    static const int    nBuffers   = 4;
+
+    // The file must stay open until finish() returns
+    WriteBehind(FileStream* file);
+    ~WriteBehind();
+
+    // Copies the data into the buffers, waiting for a buffer to be written if they
+    // are all full.  Returns false if an earlier write to the file failed.
+    bool write(const uint8_t* data, size_t length);
+
+    // Writes the rest of the data and waits until it is all in the file.  Returns
+    // false if any write failed.
+    bool finish();
+
+    size_t bytes() { return _bytes; }
+
+    // Called by the writer task
+    void drain(uint8_t* buffer, size_t length);
+
+private:
+    FileStream*   _file;
+    QueueHandle_t _free;          // The buffers that are not waiting to be written
+    int           _nBuffers = 0;  // The buffers that could be allocated
+
+    uint8_t* _current = nullptr;  // The buffer being filled
+    size_t   _fill    = 0;
+    size_t   _bytes   = 0;
+    bool     _done    = false;
+
+    std::atomic<bool> _failed;
+
+    void submit();
+};
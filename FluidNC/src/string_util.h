@@ -6,9 +6,18 @@ namespace string_util {
     char                   tolower(char c);
     bool                   equal_ignore_case(std::string_view a, std::string_view b);
     bool                   starts_with_ignore_case(std::string_view a, std::string_view b);
+    bool                   less_ignore_case(std::string_view a, std::string_view b);
     const std::string_view trim(std::string_view s);
 
     bool is_int(std::string_view s, int32_t& value);
     bool is_uint(std::string_view s, uint32_t& value);
     bool is_float(std::string_view s, float& value);
+
+    // Orders the keys of a map without regard to case.  Lookups can use any
+    // string type, so a char* key does not have to be copied into a std::string.
+    struct ignore_case_less {
+        using is_transparent = void;
+
+        bool operator()(std::string_view a, std::string_view b) const { return less_ignore_case(a, b); }
+    };
 }
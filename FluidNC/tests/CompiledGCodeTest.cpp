@@ -0,0 +1,68 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/CompiledGCode.h"
+
+#include <cstring>
+
+TEST(CompiledGCode, RoundTrip) {
+    // G1 X-1.5 Y2e6 F1000 N7, as gc_split_words() gives it
+    const gc_word_t words[] = { { 'G', 1.0f }, { 'X', -1.5f }, { 'Y', 2e6f }, { 'F', 1000.0f }, { 'N', 7.0f } };
+    const size_t    count   = sizeof(words) / sizeof(words[0]);
+
+    uint8_t record[CompiledGCode::maxWords * CompiledGCode::wordSize];
+    size_t  length = CompiledGCode::packWords(words, count, record);
+    ASSERT_EQ(length, count * CompiledGCode::wordSize);
+
+    gc_word_t unpacked[CompiledGCode::maxWords];
+    size_t    n = 0;
+    ASSERT_TRUE(CompiledGCode::unpackWords(record, length, unpacked, n));
+    ASSERT_EQ(n, count);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(unpacked[i].letter, words[i].letter);
+        EXPECT_EQ(unpacked[i].value, words[i].value);
+    }
+}
+
+TEST(CompiledGCode, PendingBlock) {
+    const gc_word_t words[] = { { 'G', 0.0f }, { 'Z', 5.0f } };
+    uint8_t         record[2 * CompiledGCode::wordSize];
+    size_t          length = CompiledGCode::packWords(words, 2, record);
+
+    gc_word_t taken[CompiledGCode::maxWords];
+    size_t    n = 0;
+    ASSERT_FALSE(CompiledGCode::takeBlock(taken, n)) << "There is no block until one is set";
+
+    ASSERT_TRUE(CompiledGCode::setBlock(record, length));
+    ASSERT_TRUE(CompiledGCode::takeBlock(taken, n));
+    ASSERT_EQ(n, 2);
+    EXPECT_EQ(taken[1].letter, 'Z');
+    ASSERT_FALSE(CompiledGCode::takeBlock(taken, n)) << "A block is taken only once";
+
+    ASSERT_TRUE(CompiledGCode::setBlock(record, length));
+    CompiledGCode::dropBlock();
+    ASSERT_FALSE(CompiledGCode::takeBlock(taken, n));
+}
+
+TEST(CompiledGCode, MalformedBlocks) {
+    uint8_t   record[(CompiledGCode::maxWords + 1) * CompiledGCode::wordSize];
+    gc_word_t words[CompiledGCode::maxWords];
+    size_t    n = 0;
+    memset(record, 'G', sizeof(record));
+
+    ASSERT_FALSE(CompiledGCode::unpackWords(record, sizeof(record), words, n)) << "More than maxWords";
+    ASSERT_FALSE(CompiledGCode::unpackWords(record, CompiledGCode::wordSize + 2, words, n)) << "Partial word";
+    ASSERT_TRUE(CompiledGCode::unpackWords(record, CompiledGCode::maxWords * CompiledGCode::wordSize, words, n));
+    ASSERT_EQ(n, CompiledGCode::maxWords);
+
+    ASSERT_FALSE(CompiledGCode::setBlock(record, sizeof(record)));
+    ASSERT_FALSE(CompiledGCode::takeBlock(words, n)) << "A rejected block is not pending";
+}
+
+TEST(CompiledGCode, Header) {
+    const char good[] = "FNCG\x01";
+    ASSERT_TRUE(CompiledGCode::isCompiled(good, 5));
+    ASSERT_FALSE(CompiledGCode::isCompiled(good, 4));
+    ASSERT_FALSE(CompiledGCode::isCompiled("G1 X1", 5));
+}
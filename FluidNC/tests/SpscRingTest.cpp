@@ -0,0 +1,144 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/SpscRing.h"
+
+#include <thread>
+
+TEST(SpscRing, StorageIsPowerOfTwo) {
+    SpscRing<int> ring;
+    ring.init(11);
+    ASSERT_EQ(ring.capacity(), 11);
+    ASSERT_EQ(ring.slots(), 16);
+
+    ring.init(16);
+    ASSERT_EQ(ring.capacity(), 16);
+    ASSERT_EQ(ring.slots(), 32) << "back() must stay free when the ring is full";
+}
+
+TEST(SpscRing, FillAndDrain) {
+    SpscRing<int> ring;
+    ring.init(5);
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.available(), 5);
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_FALSE(ring.full());
+        ring.back() = i;
+        ring.push();
+    }
+    ASSERT_TRUE(ring.full());
+    ASSERT_EQ(ring.count(), 5);
+    ASSERT_EQ(ring.available(), 0);
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_FALSE(ring.empty());
+        ASSERT_EQ(ring.front(), i);
+        ring.pop();
+    }
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(SpscRing, WrapsAround) {
+    SpscRing<uint32_t> ring;
+    ring.init(3);
+    for (uint32_t i = 0; i < 100; ++i) {
+        ring.back() = i;
+        ring.push();
+        if (ring.full()) {
+            // Walk the queued entries by position
+            uint32_t expected = ring.front();
+            for (uint32_t position = ring.tail(); position != ring.head(); ++position) {
+                ASSERT_EQ(ring.at(position), expected++);
+            }
+            ring.pop();
+        }
+    }
+    ASSERT_EQ(ring.count(), 2);
+    ASSERT_EQ(ring.front(), 98);
+}
+
+TEST(SpscRing, Clear) {
+    SpscRing<int> ring;
+    ring.init(4);
+    ring.push();
+    ring.push();
+    ring.clear();
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.head(), 0);
+}
+
+TEST(SpscRing, ProducerAndConsumerThreads) {
+    const uint32_t     n = 100000;
+    SpscRing<uint32_t> ring;
+    ring.init(7);
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < n; ++i) {
+            while (ring.full()) {
+                std::this_thread::yield();
+            }
+            ring.back() = i;
+            ring.push();
+        }
+    });
+
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        while (ring.empty()) {
+            std::this_thread::yield();
+        }
+        if (ring.front() != i) {
+            ++errors;
+        }
+        ring.pop();
+    }
+    producer.join();
+    ASSERT_EQ(errors, 0);
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(SpscRing, BulkWriteAndRead) {
+    SpscRing<uint8_t> ring;
+    ring.init(10);  // 16 slots
+
+    uint8_t in[32], out[32];
+    for (int i = 0; i < 32; ++i) {
+        in[i] = i;
+    }
+    // Start near the end of the storage so that the copies wrap
+    ASSERT_EQ(ring.write(in, 7), 7);
+    ASSERT_EQ(ring.read(out, 7), 7);
+
+    ASSERT_EQ(ring.write(in, 32), 10) << "Only the capacity is copied";
+    ASSERT_TRUE(ring.full());
+    ASSERT_EQ(ring.contiguous(), 9) << "The run stops at the end of the storage";
+
+    ASSERT_EQ(ring.read(out, 4), 4);
+    ASSERT_EQ(ring.read(out + 4, 32), 6);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(out[i], i);
+    }
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.contiguous(), 0);
+}
+
+TEST(SpscRing, DrainInPlace) {
+    SpscRing<uint8_t> ring;
+    ring.init(15);  // 16 slots
+    const uint8_t text[] = "G1X10\nG1Y20\n";
+    uint8_t       out[8];
+    ring.write(text, 12);
+    ring.read(out, 8);
+    ASSERT_EQ(ring.write(text, 12), 11);
+
+    // The queued entries wrap, so they come out in two runs
+    ASSERT_EQ(ring.contiguous(), 8);
+    ASSERT_EQ(ring.front(), 'Y');
+    ring.pop(8);
+    ASSERT_EQ(ring.contiguous(), 7);
+    ASSERT_EQ(ring.front(), '0');  // The end of "G1X10"
+    ring.pop(7);
+    ASSERT_TRUE(ring.empty());
+}
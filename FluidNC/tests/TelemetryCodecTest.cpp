@@ -0,0 +1,146 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/TelemetryCodec.h"
+
+#include <climits>
+#include <cstring>
+#include <string>
+
+namespace {
+    // Host side decoders, as a telemetry reader would write them
+    const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint32_t& value) {
+        value = 0;
+        for (int shift = 0; in < end && shift < 35; shift += 7) {
+            uint8_t byte = *in++;
+            value |= uint32_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return in;
+            }
+        }
+        return nullptr;
+    }
+
+    const uint8_t* getSigned(const uint8_t* in, const uint8_t* end, int32_t& value) {
+        uint32_t zigzag;
+        in    = getVarint(in, end, zigzag);
+        value = int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+        return in;
+    }
+
+    std::string unbase64(const std::string& text) {
+        static const std::string digits = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string bytes;
+        uint32_t    bits  = 0;
+        int         nbits = 0;
+        for (char c : text) {
+            if (c == '=') {
+                break;
+            }
+            bits = (bits << 6) | uint32_t(digits.find(c));
+            nbits += 6;
+            if (nbits >= 8) {
+                nbits -= 8;
+                bytes += char((bits >> nbits) & 0xff);
+            }
+        }
+        return bytes;
+    }
+
+    std::string base64(const std::string& bytes) {
+        char   text[64];
+        size_t length = Telemetry::base64(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), text);
+        return std::string(text, length);
+    }
+}
+
+TEST(TelemetryCodec, VarintLengths) {
+    const struct {
+        uint32_t value;
+        size_t   length;
+    } cases[] = {
+        { 0, 1 },         { 0x7f, 1 },      { 0x80, 2 },      { 0x3fff, 2 },      { 0x4000, 3 },
+        { 0x1fffff, 3 },  { 0x200000, 4 },  { 0xfffffff, 4 }, { 0x10000000, 5 },  { UINT32_MAX, 5 },
+    };
+    for (auto& c : cases) {
+        uint8_t data[Telemetry::maxVarint];
+        size_t  length = Telemetry::putVarint(c.value, data) - data;
+        EXPECT_EQ(length, c.length) << c.value;
+
+        uint32_t value;
+        EXPECT_EQ(getVarint(data, data + length, value), data + length) << c.value;
+        EXPECT_EQ(value, c.value);
+    }
+}
+
+TEST(TelemetryCodec, VarintBytes) {
+    uint8_t data[Telemetry::maxVarint];
+    ASSERT_EQ(Telemetry::putVarint(300, data) - data, 2);
+    EXPECT_EQ(data[0], 0xac) << "low 7 bits first, with the continuation bit";
+    EXPECT_EQ(data[1], 0x02);
+}
+
+TEST(TelemetryCodec, ZigzagRoundTrip) {
+    const int32_t values[] = { 0, -1, 1, -2, 63, -64, 64, -65, 8191, -8192, 1000000, -1000000, INT32_MAX, INT32_MIN };
+    for (int32_t v : values) {
+        uint8_t data[Telemetry::maxVarint];
+        size_t  length = Telemetry::putSigned(v, data) - data;
+
+        int32_t value;
+        EXPECT_EQ(getSigned(data, data + length, value), data + length) << v;
+        EXPECT_EQ(value, v);
+    }
+}
+
+TEST(TelemetryCodec, ZigzagKeepsSmallNegativesShort) {
+    uint8_t data[Telemetry::maxVarint];
+    EXPECT_EQ(Telemetry::putSigned(-1, data) - data, 1);
+    EXPECT_EQ(data[0], 1);
+    EXPECT_EQ(Telemetry::putSigned(-64, data) - data, 1);
+    EXPECT_EQ(Telemetry::putSigned(-65, data) - data, 2);
+    EXPECT_EQ(Telemetry::putSigned(INT32_MIN, data) - data, 5);
+}
+
+TEST(TelemetryCodec, Base64Padding) {
+    // RFC 4648 test vectors
+    EXPECT_EQ(base64(""), "");
+    EXPECT_EQ(base64("f"), "Zg==");
+    EXPECT_EQ(base64("fo"), "Zm8=");
+    EXPECT_EQ(base64("foo"), "Zm9v");
+    EXPECT_EQ(base64("foob"), "Zm9vYg==");
+    EXPECT_EQ(base64("fooba"), "Zm9vYmE=");
+    EXPECT_EQ(base64("foobar"), "Zm9vYmFy");
+}
+
+TEST(TelemetryCodec, Base64RoundTrip) {
+    std::string bytes;
+    for (int i = 0; i < 40; ++i) {
+        bytes += char(i * 37 + 200);  // Every length mod 3, and bytes with the high bit set
+        std::string text = base64(bytes);
+        EXPECT_EQ(text.size(), 4 * ((bytes.size() + 2) / 3));
+        EXPECT_EQ(unbase64(text), bytes) << text;
+    }
+}
+
+TEST(TelemetryCodec, FrameRoundTrip) {
+    // A step field as a frame carries it, sent through base64
+    const int32_t steps[] = { 12345, -1, 0, -987654 };
+    uint8_t       frame[4 * Telemetry::maxVarint];
+    uint8_t*      out = frame;
+    for (int32_t s : steps) {
+        out = Telemetry::putSigned(s, out);
+    }
+    std::string bytes = unbase64(base64(std::string(reinterpret_cast<char*>(frame), out - frame)));
+
+    const uint8_t* in  = reinterpret_cast<const uint8_t*>(bytes.data());
+    const uint8_t* end = in + bytes.size();
+    for (int32_t s : steps) {
+        int32_t value;
+        in = getSigned(in, end, value);
+        ASSERT_NE(in, nullptr);
+        EXPECT_EQ(value, s);
+    }
+    EXPECT_EQ(in, end);
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+// mDNS is only used by the WiFi services, which are not built for the host.
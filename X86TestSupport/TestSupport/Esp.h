@@ -21,6 +21,7 @@ esp_reset_reason_t esp_reset_reason(void);
 struct EspClass {
     uint64_t    getEfuseMac();
     uint32_t    getCpuFreqMHz();
+    uint8_t     getChipCores();
     const char* getSdkVersion();
     uint32_t    getFreeHeap();
     uint32_t    getFlashChipSize();
@@ -208,14 +208,18 @@ std::exception CreateException(const char* condition, const char* msg) {
 
 #else
 
-std::exception CreateException(const char* condition, const char* msg) {
+#    include <sstream>
+#    include <stdexcept>
+#    include <string>
+
+std::runtime_error CreateException(const char* condition, const char* msg) {
     static std::string container;  // Exception data _must_ be stored in a static string!
     std::ostringstream oss;
     oss << std::endl;
     oss << "Error: " << condition << " failed: " << msg << " at: " << std::endl;
 
     container = oss.str();
-    return std::exception(container.c_str()); /* this is usually where you want a breakpoint. */
+    return std::runtime_error(container); /* this is usually where you want a breakpoint. */
 }
 
 #endif
@@ -0,0 +1,51 @@
+#pragma once
+
+// Minimal stand-in for the ThingPulse OLEDDisplay class so that OLED.cpp and
+// SSD1306_I2C.h compile on the host.  Nothing is drawn.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define OLEDDISPLAY_DOUBLE_BUFFER
+
+#define COLUMNADDR 0x21
+#define PAGEADDR 0x22
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT { TEXT_ALIGN_LEFT = 0, TEXT_ALIGN_RIGHT = 1, TEXT_ALIGN_CENTER = 2, TEXT_ALIGN_CENTER_BOTH = 3 };
+
+enum OLEDDISPLAY_GEOMETRY { GEOMETRY_128_64 = 0, GEOMETRY_128_32 = 1, GEOMETRY_64_48 = 2, GEOMETRY_64_32 = 3, GEOMETRY_RAWMODE = 4 };
+
+// Font headers are width, height, first char, number of chars
+static const uint8_t ArialMT_Plain_10[] = { 10, 13, 32, 0 };
+static const uint8_t ArialMT_Plain_16[] = { 16, 19, 32, 0 };
+static const uint8_t ArialMT_Plain_24[] = { 24, 28, 32, 0 };
+
+class OLEDDisplay {
+protected:
+    OLEDDISPLAY_GEOMETRY geometry          = GEOMETRY_128_64;
+    uint8_t*             buffer            = nullptr;
+    uint8_t*             buffer_back       = nullptr;
+    uint16_t             displayBufferSize = 0;
+
+    void yield() {}
+
+public:
+    virtual ~OLEDDisplay() = default;
+
+    void     setGeometry(OLEDDISPLAY_GEOMETRY g) { geometry = g; }
+    uint16_t width() { return (geometry == GEOMETRY_64_48 || geometry == GEOMETRY_64_32) ? 64 : 128; }
+    uint16_t height() { return (geometry == GEOMETRY_128_32 || geometry == GEOMETRY_64_32) ? 32 : (geometry == GEOMETRY_64_48 ? 48 : 64); }
+
+    bool init() { return true; }
+    void clear() {}
+    void flipScreenVertically() {}
+    void setFont(const uint8_t* font) {}
+    void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT align) {}
+    void drawString(int16_t x, int16_t y, const std::string& text) {}
+    void drawProgressBar(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t progress) {}
+    void drawRect(int16_t x, int16_t y, int16_t width, int16_t height) {}
+    void fillRect(int16_t x, int16_t y, int16_t width, int16_t height) {}
+
+    virtual void display() {}
+};
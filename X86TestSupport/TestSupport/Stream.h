@@ -47,7 +47,7 @@ public:
     virtual int  available() = 0;
     virtual int  read()      = 0;
     virtual int  peek()      = 0;
-    virtual void flush()     = 0;
+    virtual void flush() {}
 
     Stream() : _startMillis(0) { _timeout = 1000; }
     virtual ~Stream() {}
@@ -3,13 +3,10 @@
 #include <iomanip>
 #include <sstream>
 
-#pragma warning(disable : 4996)  // itoa
-
 std::string String::ValueToString(int value, int base) {
-    char        buffer[100] = { 0 };
-    int         number_base = 10;
-    std::string output      = itoa(value, buffer, base);
-    return output;
+    char buffer[100] = { 0 };
+    snprintf(buffer, sizeof(buffer), base == 16 ? "%x" : (base == 8 ? "%o" : "%d"), value);
+    return buffer;
 }
 
 std::string String::DecToString(double value, int decimalPlaces) {
@@ -70,12 +70,12 @@ typedef enum {
      * @brief Data struct of RMT TX configure parameters
      */
 typedef struct {
-    bool                loop_en;              /*!< Enable sending RMT items in a loop */
     uint32_t            carrier_freq_hz;      /*!< RMT carrier frequency */
-    uint8_t             carrier_duty_percent; /*!< RMT carrier duty (%) */
     rmt_carrier_level_t carrier_level;        /*!< Level of the RMT output, when the carrier is applied */
-    bool                carrier_en;           /*!< RMT carrier enable */
     rmt_idle_level_t    idle_level;           /*!< RMT idle level */
+    uint8_t             carrier_duty_percent; /*!< RMT carrier duty (%) */
+    bool                carrier_en;           /*!< RMT carrier enable */
+    bool                loop_en;              /*!< Enable sending RMT items in a loop */
     bool                idle_output_en;       /*!< RMT idle level output enable */
 } rmt_tx_config_t;
 
@@ -91,9 +91,10 @@ typedef struct {
 typedef struct {
     rmt_mode_t    rmt_mode;      /*!< RMT mode: transmitter or receiver */
     rmt_channel_t channel;       /*!< RMT channel */
-    uint8_t       clk_div;       /*!< RMT channel counter divider */
     int           gpio_num;      /*!< RMT GPIO number */
+    uint8_t       clk_div;       /*!< RMT channel counter divider */
     uint8_t       mem_block_num; /*!< RMT memory block number */
+    uint32_t      flags;         /*!< RMT channel extra configurations, OR'd with RMT_CHANNEL_FLAGS_[*] */
     union {
         rmt_tx_config_t tx_config; /*!< RMT TX parameter */
         rmt_rx_config_t rx_config; /*!< RMT RX parameter */
@@ -0,0 +1,6 @@
+#pragma once
+
+// Only the types named by Driver/spi.h are needed on the host.
+
+struct spi_device_t;
+typedef spi_device_t* spi_device_handle_t;
@@ -1 +1,10 @@
 #pragma once
+
+#include "freertos/FreeRTOS.h"  // xPortGetFreeHeapSize()
+
+#include <cstdint>
+
+// The host does not keep a low-water mark for the heap, so this is the current free size
+inline uint32_t esp_get_minimum_free_heap_size() {
+    return xPortGetFreeHeapSize();
+}
@@ -1,8 +1,9 @@
 #pragma once
 
-#include "Task.h"
-#include "Queue.h"
+#include "task.h"
+#include "queue.h"
 #include "FreeRTOSTypes.h"
+#include <malloc.h>  // mallinfo2()
 #include <mutex>
 #include <atomic>
 
@@ -26,6 +27,7 @@ inline void vTaskEnterCritical(portMUX_TYPE* mux) {
     mux->unlock();
 }
 
+// The host heap has no fixed size, so pretend to have 4 MB, less what malloc has handed out
 inline int32_t xPortGetFreeHeapSize() {
-    return 1024 * 1024 * 4;
+    return 1024 * 1024 * 4 - int32_t(mallinfo2().uordblks);
 }
@@ -1,4 +1,4 @@
-#include "Task.h"
+#include "task.h"
 
 #include "Capture.h"
 #include "../Arduino.h"
@@ -7,12 +7,24 @@
 // use thread fibers like MS ConvertThreadToFiber and CreateFiber. That way, we can have 2 threads (one for
 // each CPU) and then allocate multiple cooperative (non-preemptive) fibers on it.
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <memory>
 
 std::vector<std::unique_ptr<std::thread>> threads;
 
+// A task handle points to the notification value of the task.
+struct TaskNotification {
+    std::mutex              mutex;
+    std::condition_variable cv;
+    uint32_t                value = 0;
+};
+
+static thread_local TaskNotification* currentTask = nullptr;
+
 BaseType_t xTaskCreatePinnedToCore(TaskFunction_t      pvTaskCode,
                                    const char* const   pcName,
                                    const uint32_t      usStackDepth,
@@ -20,13 +32,58 @@ BaseType_t xTaskCreatePinnedToCore(TaskFunction_t      pvTaskCode,
                                    UBaseType_t         uxPriority,
                                    TaskHandle_t* const pvCreatedTask,
                                    const BaseType_t    xCoreID) {
-    std::unique_ptr<std::thread> thread = std::make_unique<std::thread>(pvTaskCode, pvParameters);
+    auto task = new TaskNotification;  // Never freed, because tasks run until the program exits
+    if (pvCreatedTask) {
+        *pvCreatedTask = task;
+    }
+    std::unique_ptr<std::thread> thread = std::make_unique<std::thread>([=] {
+        currentTask = task;
+        pvTaskCode(pvParameters);
+    });
+    thread->detach();  // Tasks run until the program exits
     threads.emplace_back(std::move(thread));
     return pdTRUE;
 }
 
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return currentTask;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    if (!currentTask) {
+        currentTask = new TaskNotification;
+    }
+    auto&                        task = *currentTask;
+    std::unique_lock<std::mutex> lock(task.mutex);
+    if (xTicksToWait == portMAX_DELAY) {
+        task.cv.wait(lock, [&] { return task.value != 0; });
+    } else {
+        task.cv.wait_for(lock, std::chrono::milliseconds(xTicksToWait), [&] { return task.value != 0; });
+    }
+    uint32_t value = task.value;
+    if (value) {
+        task.value = xClearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+    auto& task = *static_cast<TaskNotification*>(xTaskToNotify);
+    {
+        std::lock_guard<std::mutex> lock(task.mutex);
+        ++task.value;
+    }
+    task.cv.notify_one();
+    return pdTRUE;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken) {
+    xTaskNotifyGive(xTaskToNotify);
+}
+
 void vTaskDelay(const TickType_t xTicksToDelay) {
     Capture::instance().wait(xTicksToDelay);
+    std::this_thread::yield();  // Let the other tasks run, as the real vTaskDelay() would
 }
 
 void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, const TickType_t xTimeIncrement) {
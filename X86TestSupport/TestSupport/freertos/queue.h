@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Task.h"
+#include "task.h"
 #include "FreeRTOSTypes.h"
 
 #include <queue>
@@ -39,6 +39,10 @@ BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue);
 
 BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void* const pvItemToQueue, TickType_t xTicksToWait, BaseType_t xCopyPosition);
 
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+
+void vQueueDelete(QueueHandle_t xQueue);
+
 #define xQueueSendFromISR(xQueue, pvItemToQueue, pxHigherPriorityTaskWoken)                                                                \
     xQueueGenericSendFromISR((xQueue), (pvItemToQueue), (pxHigherPriorityTaskWoken), queueSEND_TO_BACK)
 
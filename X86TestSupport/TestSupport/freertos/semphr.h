@@ -0,0 +1,26 @@
+#pragma once
+
+#include "queue.h"  // pdTRUE
+
+#include <chrono>
+#include <mutex>
+
+// Only recursive mutexes are modelled. Priority inheritance is not.
+using SemaphoreHandle_t = std::recursive_timed_mutex*;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    return new std::recursive_timed_mutex();
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xTicksToWait) {
+    if (xTicksToWait == portMAX_DELAY) {
+        xMutex->lock();
+        return pdTRUE;
+    }
+    return xMutex->try_lock_for(std::chrono::milliseconds(xTicksToWait)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex) {
+    xMutex->unlock();
+    return pdTRUE;
+}
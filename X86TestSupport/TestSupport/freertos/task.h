@@ -4,6 +4,8 @@
 #include "FreeRTOS.h"
 #include "FreeRTOSTypes.h"
 
+#include <climits>
+
 void vTaskDelay(const TickType_t xTicksToDelay);
 
 #define CONFIG_ARDUINO_RUNNING_CORE 0
@@ -31,6 +33,19 @@ void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, const TickType_t xTim
 
 TickType_t xTaskGetTickCount(void);
 
+// Threads that were not created as tasks, like the main one, have no handle.
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+// Task notifications, used as counting semaphores. The tick count of a wait is taken as milliseconds.
+uint32_t   ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void       vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t* pxHigherPriorityTaskWoken);
+
+// Tasks run as free-running std::threads, so priorities and suspension are not modelled.
+inline void vTaskSuspend(TaskHandle_t xTaskToSuspend) {}
+inline void vTaskResume(TaskHandle_t xTaskToResume) {}
+inline void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority) {}
+
 #define CONFIG_FREERTOS_HZ 1000
 #define configTICK_RATE_HZ (CONFIG_FREERTOS_HZ)
 #define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host builds do not target a specific ESP32 variant, so none of the
+// CONFIG_IDF_TARGET_* symbols are defined here.